@@ -0,0 +1,157 @@
+#include "arena.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+using namespace std;
+
+FrameArena::FrameArena(size_t capacity) : block(new unsigned char[capacity]), size(capacity) {
+}
+
+void* FrameArena::allocate(size_t bytes, size_t align) {
+    size_t start = (offset + align - 1) & ~(align - 1);
+    if (start + bytes <= size) {
+        offset = start + bytes;
+        peak = max(peak, used());
+        return block.get() + start;
+    }
+
+    //Out of room: hand out a separate heap block until the next reset
+    if (overflow.empty()) {
+        overflows++;
+    }
+    overflow.emplace_back(new unsigned char[bytes + align]);
+    overflowBytes += bytes + align;
+    peak = max(peak, used());
+    size_t address = reinterpret_cast<size_t>(overflow.back().get());
+    return reinterpret_cast<void*>((address + align - 1) & ~(align - 1));
+}
+
+void FrameArena::reset() {
+    if (!overflow.empty()) {
+        overflow.clear();
+        overflowBytes = 0;
+        //Grow once, with some headroom, so the next busy tick fits
+        size = peak + peak / 2;
+        block.reset(new unsigned char[size]);
+    }
+    offset = 0;
+}
+
+#ifdef ALLOC_DEBUG
+
+static atomic<unsigned long long> allocationCount(0);
+static atomic<unsigned long long> allocationBytes(0);
+//Plain integers, so counting needs no TLS constructor inside operator new
+static thread_local unsigned long long threadAllocationCount = 0;
+static thread_local unsigned long long threadAllocationBytes = 0;
+
+static void* countedAlloc(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    allocationBytes.fetch_add(size, memory_order_relaxed);
+    threadAllocationCount++;
+    threadAllocationBytes += size;
+    return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size) {
+    void* memory = countedAlloc(size);
+    if (!memory) throw bad_alloc();
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    void* memory = countedAlloc(size);
+    if (!memory) throw bad_alloc();
+    return memory;
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+    return countedAlloc(size);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+    free(memory);
+}
+
+bool allocCountingEnabled() {
+    return true;
+}
+
+AllocStats allocStats() {
+    AllocStats stats;
+    stats.allocations = threadAllocationCount;
+    stats.bytes = threadAllocationBytes;
+    return stats;
+}
+
+AllocStats processAllocStats() {
+    AllocStats stats;
+    stats.allocations = allocationCount.load(memory_order_relaxed);
+    stats.bytes = allocationBytes.load(memory_order_relaxed);
+    return stats;
+}
+
+#else
+
+bool allocCountingEnabled() {
+    return false;
+}
+
+AllocStats allocStats() {
+    return AllocStats();
+}
+
+AllocStats processAllocStats() {
+    return AllocStats();
+}
+
+#endif
+
+//Only the first few offending frames are printed
+static const unsigned long long MAX_REPORTS = 10;
+
+AllocFrameMonitor::AllocFrameMonitor(const char* label, unsigned warmupFrames, AllocScope scope)
+    : label(label), warmup(warmupFrames), scope(scope) {
+}
+
+AllocStats AllocFrameMonitor::now() const {
+    return scope == ALLOC_PROCESS ? processAllocStats() : allocStats();
+}
+
+void AllocFrameMonitor::beginFrame() {
+    start = now();
+}
+
+void AllocFrameMonitor::endFrame() {
+    AllocStats end = now();
+    last.allocations = end.allocations - start.allocations;
+    last.bytes = end.bytes - start.bytes;
+    frame++;
+    if (frame > warmup && last.allocations > 0) {
+        flagged++;
+        if (flagged <= MAX_REPORTS) {
+            cerr << "Warning: " << label << " frame " << frame << " made " << last.allocations << " allocations (" << last.bytes
+                 << " bytes) after warm-up"
+                 << (scope == ALLOC_PROCESS ? " across all threads" : " on its own thread") << endl;
+        }
+    }
+}
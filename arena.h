@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Bump allocator for data that only lives for one tick. allocate() moves an
+// offset forward and reset() moves it back, so a tick's scratch space costs
+// no heap traffic once the block is big enough. A tick that runs out of room
+// gets extra blocks from the heap, and the next reset() replaces everything
+// with one block big enough for the busiest tick seen so far.
+//
+// Nothing is constructed or destroyed, so only trivially destructible types
+// belong here.
+
+class FrameArena {
+public:
+    explicit FrameArena(size_t capacity = 64 * 1024);
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+    template <class T>
+    T* allocArray(size_t count) {
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+    void reset();
+
+    size_t used() const { return offset + overflowBytes; }
+    size_t capacity() const { return size; }
+    size_t highWater() const { return peak; }
+    //Ticks that did not fit in the block
+    unsigned overflowCount() const { return overflows; }
+
+private:
+    std::unique_ptr<unsigned char[]> block;
+    size_t size = 0;
+    size_t offset = 0;
+    size_t peak = 0;
+    std::vector<std::unique_ptr<unsigned char[]>> overflow;
+    size_t overflowBytes = 0;
+    unsigned overflows = 0;
+};
+
+// Heap allocation counters. Building with -DALLOC_DEBUG replaces the global
+// operator new and delete so every allocation is counted, both per thread
+// and for the whole process; without it the counters stay at zero and
+// nothing is replaced.
+
+struct AllocStats {
+    unsigned long long allocations = 0;
+    unsigned long long bytes = 0;
+};
+
+bool allocCountingEnabled();
+//Allocations made by the calling thread
+AllocStats allocStats();
+//Allocations made by every thread, including ones this thread never waits on
+AllocStats processAllocStats();
+
+enum AllocScope {
+    ALLOC_THIS_THREAD,   // only the thread calling beginFrame/endFrame
+    ALLOC_PROCESS        // every thread; for frames that fan work out to others
+};
+
+// Checks that frames stop allocating once the game has warmed up. Each
+// frame that still allocates after warmupFrames is counted, and the first
+// few are reported on stderr. By default only the monitoring thread's own
+// allocations count, so a frame is not blamed for what other threads, such
+// as the simulation, happen to do at the same time.
+
+class AllocFrameMonitor {
+public:
+    AllocFrameMonitor(const char* label, unsigned warmupFrames = 120, AllocScope scope = ALLOC_THIS_THREAD);
+
+    void beginFrame();
+    void endFrame();
+
+    unsigned long long frames() const { return frame; }
+    unsigned long long flaggedFrames() const { return flagged; }
+    const AllocStats& lastFrame() const { return last; }
+
+private:
+    AllocStats now() const;
+
+    const char* label;
+    unsigned warmup;
+    AllocScope scope;
+    unsigned long long frame = 0;
+    unsigned long long flagged = 0;
+    AllocStats start;
+    AllocStats last;
+};
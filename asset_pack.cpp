@@ -0,0 +1,167 @@
+#include "asset_pack.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+using namespace std;
+
+static bool nameLess(const PackEntry& entry, const string& name) {
+    return strncmp(entry.name, name.c_str(), PACK_NAME_SIZE) < 0;
+}
+
+//Decoded entries must hold exactly what their dimensions say, since
+//loading one copies a*b*4 bytes (images) or whole frames (sounds)
+static bool shapeMatches(const PackEntry& entry) {
+    const unsigned MAX_IMAGE_SIDE = 1 << 15;
+    const unsigned MAX_CHANNELS = 8;
+    const unsigned MAX_SAMPLE_RATE = 384000;
+    switch (entry.kind) {
+    case PACK_IMAGE:
+        return entry.a > 0 && entry.b > 0 && entry.a <= MAX_IMAGE_SIDE && entry.b <= MAX_IMAGE_SIDE &&
+               entry.size == static_cast<unsigned long long>(entry.a) * entry.b * 4;
+    case PACK_SOUND:
+        return entry.a > 0 && entry.a <= MAX_CHANNELS && entry.b > 0 && entry.b <= MAX_SAMPLE_RATE &&
+               entry.size % (static_cast<unsigned long long>(entry.a) * sizeof(short)) == 0;
+    case PACK_RAW:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool AssetPack::open(const string& path) {
+    close();
+    if (!file.open(path)) {
+        return false;
+    }
+    PackHeader header;
+    if (file.size() < sizeof(header)) {
+        close();
+        return false;
+    }
+    memcpy(&header, file.data(), sizeof(header));
+    if (memcmp(header.magic, PackHeader().magic, sizeof(header.magic)) != 0 || header.version != ASSET_PACK_VERSION) {
+        cerr << "Error: " << path << " is not a version " << ASSET_PACK_VERSION << " asset pack" << endl;
+        close();
+        return false;
+    }
+    size_t indexEnd = sizeof(header) + static_cast<size_t>(header.entryCount) * sizeof(PackEntry);
+    if (indexEnd > file.size()) {
+        cerr << "Error: " << path << " is truncated" << endl;
+        close();
+        return false;
+    }
+    //Header and records are multiples of 16 bytes, so the records can be read in place
+    const PackEntry* first = reinterpret_cast<const PackEntry*>(file.data() + sizeof(header));
+    for (size_t i = 0; i < header.entryCount; i++) {
+        const PackEntry& entry = first[i];
+        bool inside = entry.offset >= indexEnd && entry.offset <= file.size() && entry.size <= file.size() - entry.offset;
+        bool named = memchr(entry.name, 0, PACK_NAME_SIZE) != nullptr;
+        //find() binary-searches the names, so they must be sorted and unique
+        bool ordered = i == 0 || strncmp(first[i - 1].name, entry.name, PACK_NAME_SIZE) < 0;
+        if (!inside || !named || !ordered || entry.offset % PACK_ALIGNMENT != 0 || !shapeMatches(entry)) {
+            cerr << "Error: " << path << " has a damaged entry " << i << endl;
+            close();
+            return false;
+        }
+    }
+    entries = first;
+    count = header.entryCount;
+    return true;
+}
+
+void AssetPack::close() {
+    file.close();
+    entries = nullptr;
+    count = 0;
+}
+
+const PackEntry* AssetPack::find(const string& name) const {
+    if (!entries || name.size() >= PACK_NAME_SIZE) {
+        return nullptr;
+    }
+    const PackEntry* end = entries + count;
+    const PackEntry* found = lower_bound(entries, end, name, nameLess);
+    return found != end && name == found->name ? found : nullptr;
+}
+
+bool AssetPackWriter::add(const string& name, unsigned kind, unsigned a, unsigned b, const void* bytes, size_t size) {
+    if (name.empty() || name.size() >= PACK_NAME_SIZE) {
+        return false;
+    }
+    for (const PackEntry& entry : index) {
+        if (name == entry.name) {
+            return false;
+        }
+    }
+    PackEntry entry;
+    memcpy(entry.name, name.data(), name.size());
+    entry.kind = kind;
+    entry.a = a;
+    entry.b = b;
+    entry.size = size;
+    //Never write what open() would refuse
+    if (!shapeMatches(entry)) {
+        return false;
+    }
+    //Offsets are relative to the data section until write() knows where it starts
+    blob.resize((blob.size() + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT);
+    entry.offset = blob.size();
+    const unsigned char* begin = static_cast<const unsigned char*>(bytes);
+    blob.insert(blob.end(), begin, begin + size);
+    index.push_back(entry);
+    return true;
+}
+
+bool AssetPackWriter::addImage(const string& name, unsigned width, unsigned height, const unsigned char* rgba) {
+    return add(name, PACK_IMAGE, width, height, rgba, static_cast<size_t>(width) * height * 4);
+}
+
+bool AssetPackWriter::addSound(const string& name, unsigned channels, unsigned sampleRate, const short* samples, size_t sampleCount) {
+    return add(name, PACK_SOUND, channels, sampleRate, samples, sampleCount * sizeof(short));
+}
+
+bool AssetPackWriter::addRaw(const string& name, const unsigned char* bytes, size_t size) {
+    return add(name, PACK_RAW, 0, 0, bytes, size);
+}
+
+bool AssetPackWriter::write(const string& path) const {
+    PackHeader header;
+    header.entryCount = static_cast<unsigned>(index.size());
+    size_t dataStart = sizeof(header) + index.size() * sizeof(PackEntry);
+    dataStart = (dataStart + PACK_ALIGNMENT - 1) / PACK_ALIGNMENT * PACK_ALIGNMENT;
+
+    vector<PackEntry> sorted = index;
+    sort(sorted.begin(), sorted.end(), [](const PackEntry& x, const PackEntry& y) { return strncmp(x.name, y.name, PACK_NAME_SIZE) < 0; });
+    for (PackEntry& entry : sorted) {
+        entry.offset += dataStart;
+    }
+
+    string tempPath = path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        cerr << "Error: Could not create " << tempPath << endl;
+        return false;
+    }
+    static const unsigned char padding[PACK_ALIGNMENT] = {};
+    size_t indexEnd = sizeof(header) + sorted.size() * sizeof(PackEntry);
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && fwrite(sorted.data(), sizeof(PackEntry), sorted.size(), file) == sorted.size();
+    ok = ok && fwrite(padding, 1, dataStart - indexEnd, file) == dataStart - indexEnd;
+    ok = ok && fwrite(blob.data(), 1, blob.size(), file) == blob.size();
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        cerr << "Error: Could not write " << tempPath << endl;
+        return false;
+    }
+
+    error_code error;
+    filesystem::rename(tempPath, path, error);
+    if (error) {
+        cerr << "Error: Could not replace " << path << endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "mapped_file.h"
+
+// Single-file asset archive, written offline by the packer tool and
+// memory-mapped at runtime. Images are stored decoded as RGBA8 and sound
+// effects as 16-bit PCM, so loading one is a copy to the GPU or OpenAL
+// rather than a JPEG/PNG/MP3 decode. Fonts and streamed music keep their
+// original bytes; SFML reads those straight out of the mapping.
+//
+// Layout (little-endian): PackHeader, then entryCount PackEntry records
+// sorted by name, then the data. Every blob starts on a 16-byte boundary.
+// Entries are named by the path the game asks for, e.g.
+// "texture/back ground.jpg", so the archive is a drop-in for loose files.
+
+const unsigned ASSET_PACK_VERSION = 1;
+const size_t PACK_NAME_SIZE = 96;
+const size_t PACK_ALIGNMENT = 16;
+
+enum PackKind : unsigned {
+    PACK_IMAGE = 1,     // a = width, b = height, RGBA8 rows top to bottom
+    PACK_SOUND = 2,     // a = channels, b = sample rate, interleaved Int16
+    PACK_RAW = 3        // the original file bytes
+};
+
+struct PackHeader {
+    char magic[4] = { 'R', 'B', 'P', 'K' };
+    unsigned version = ASSET_PACK_VERSION;
+    unsigned entryCount = 0;
+    unsigned reserved = 0;
+};
+
+struct PackEntry {
+    char name[PACK_NAME_SIZE] = {};
+    unsigned kind = 0;
+    unsigned a = 0;
+    unsigned b = 0;
+    unsigned reserved = 0;
+    unsigned long long offset = 0;
+    unsigned long long size = 0;
+};
+
+static_assert(sizeof(PackHeader) == 16, "PackHeader is written as-is");
+static_assert(sizeof(PackEntry) == PACK_NAME_SIZE + 32, "PackEntry is written as-is");
+
+class AssetPack {
+public:
+    //Maps the archive and checks every entry lies inside it and, for decoded
+    //images and sounds, holds exactly the bytes its dimensions call for;
+    //false if it is missing or damaged
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return file.isOpen() && entries != nullptr; }
+    size_t entryCount() const { return count; }
+    //Binary search over the sorted entries; nullptr if the name is not packed
+    const PackEntry* find(const std::string& name) const;
+    const unsigned char* data(const PackEntry& entry) const { return file.data() + entry.offset; }
+
+private:
+    MappedFile file;
+    const PackEntry* entries = nullptr;
+    size_t count = 0;
+};
+
+// Builds an archive in memory and writes it in one go, through a temporary
+// file renamed over the old one, so a running game never maps half a pack.
+
+class AssetPackWriter {
+public:
+    //False if the name does not fit, is already in the archive, or the dimensions are out of range
+    bool addImage(const std::string& name, unsigned width, unsigned height, const unsigned char* rgba);
+    bool addSound(const std::string& name, unsigned channels, unsigned sampleRate, const short* samples, size_t sampleCount);
+    bool addRaw(const std::string& name, const unsigned char* bytes, size_t size);
+
+    bool write(const std::string& path) const;
+    size_t dataBytes() const { return blob.size(); }
+
+private:
+    bool add(const std::string& name, unsigned kind, unsigned a, unsigned b, const void* bytes, size_t size);
+
+    std::vector<PackEntry> index;
+    std::vector<unsigned char> blob;
+};
@@ -0,0 +1,167 @@
+#include "audio.h"
+#include <chrono>
+
+using namespace sf;
+using namespace std;
+
+//Upper bound on how long a trigger can wait if its wake-up is missed
+static const chrono::milliseconds MAX_IDLE_WAIT(2);
+
+static long long nowMicros() {
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+AudioSystem::AudioSystem(unsigned voiceCount) : cells(QUEUE_SIZE), voices(voiceCount > 0 ? voiceCount : 1) {
+    for (size_t i = 0; i < cells.size(); i++) {
+        cells[i].sequence.store(i, memory_order_relaxed);
+    }
+    thread = std::thread(&AudioSystem::audioLoop, this);
+}
+
+AudioSystem::~AudioSystem() {
+    stopping = true;
+    wake.notify_one();
+    thread.join();
+    for (auto& voice : voices) {
+        voice.sound.stop();
+        voice.sound.resetBuffer();
+    }
+}
+
+void AudioSystem::setEffect(SoundEffect effect, const SoundBuffer* buffer, int priority, int maxVoices) {
+    effects[effect].priority.store(priority, memory_order_relaxed);
+    effects[effect].maxVoices.store(maxVoices > 0 ? maxVoices : 1, memory_order_relaxed);
+    effects[effect].buffer.store(buffer, memory_order_release);
+}
+
+bool AudioSystem::trigger(SoundEffect effect) {
+    triggers.fetch_add(1, memory_order_relaxed);
+    size_t pos = enqueuePos.load(memory_order_relaxed);
+    while (true) {
+        Cell& cell = cells[pos % QUEUE_SIZE];
+        size_t sequence = cell.sequence.load(memory_order_acquire);
+        long long lag = static_cast<long long>(sequence - pos);
+        if (lag == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                cell.trigger.effect = effect;
+                cell.trigger.queuedAt = nowMicros();
+                cell.sequence.store(pos + 1, memory_order_release);
+                wake.notify_one();
+                return true;
+            }
+        }
+        else if (lag < 0) {
+            //Full: the audio thread has not freed this cell yet
+            dropped.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+        else {
+            pos = enqueuePos.load(memory_order_relaxed);
+        }
+    }
+}
+
+bool AudioSystem::pop(Trigger& trigger) {
+    Cell& cell = cells[dequeuePos % QUEUE_SIZE];
+    if (cell.sequence.load(memory_order_acquire) != dequeuePos + 1) {
+        return false;
+    }
+    trigger = cell.trigger;
+    cell.sequence.store(dequeuePos + QUEUE_SIZE, memory_order_release);
+    dequeuePos++;
+    return true;
+}
+
+void AudioSystem::play(const Trigger& trigger) {
+    const Effect& effect = effects[trigger.effect];
+    const SoundBuffer* buffer = effect.buffer.load(memory_order_acquire);
+    if (!buffer) {
+        dropped.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    int priority = effect.priority.load(memory_order_relaxed);
+    int maxVoices = effect.maxVoices.load(memory_order_relaxed);
+
+    Voice* freeVoice = nullptr;
+    Voice* oldestSame = nullptr;
+    Voice* victim = nullptr;
+    int sameCount = 0;
+    for (auto& voice : voices) {
+        if (voice.sound.getStatus() != SoundSource::Playing) {
+            if (!freeVoice) freeVoice = &voice;
+            continue;
+        }
+        if (voice.effect == trigger.effect) {
+            sameCount++;
+            if (!oldestSame || voice.startedAt < oldestSame->startedAt) oldestSame = &voice;
+        }
+        if (voice.priority <= priority &&
+            (!victim || voice.priority < victim->priority || (voice.priority == victim->priority && voice.startedAt < victim->startedAt))) {
+            victim = &voice;
+        }
+    }
+
+    Voice* chosen = nullptr;
+    if (sameCount >= maxVoices) {
+        chosen = oldestSame;
+    }
+    else if (freeVoice) {
+        chosen = freeVoice;
+    }
+    else {
+        chosen = victim;
+    }
+    if (!chosen) {
+        dropped.fetch_add(1, memory_order_relaxed);
+        return;
+    }
+    if (chosen->sound.getStatus() == SoundSource::Playing) {
+        stolen.fetch_add(1, memory_order_relaxed);
+    }
+
+    chosen->sound.setBuffer(*buffer);
+    chosen->sound.play();
+    chosen->effect = trigger.effect;
+    chosen->priority = priority;
+    chosen->startedAt = ++voiceStarts;
+
+    long long latency = nowMicros() - trigger.queuedAt;
+    played.fetch_add(1, memory_order_relaxed);
+    latencySum.fetch_add(latency, memory_order_relaxed);
+    if (latency > latencyMax.load(memory_order_relaxed)) {
+        latencyMax.store(latency, memory_order_relaxed);
+    }
+}
+
+void AudioSystem::audioLoop() {
+    while (!stopping.load(memory_order_relaxed)) {
+        Trigger trigger;
+        while (pop(trigger)) {
+            play(trigger);
+        }
+        //Producers never take this lock, so a wake-up can slip past; the timeout bounds that
+        unique_lock<mutex> guard(wakeLock);
+        wake.wait_for(guard, MAX_IDLE_WAIT, [&] {
+            return stopping.load(memory_order_relaxed) || cells[dequeuePos % QUEUE_SIZE].sequence.load(memory_order_acquire) == dequeuePos + 1;
+        });
+    }
+}
+
+AudioStats AudioSystem::stats() const {
+    AudioStats result;
+    result.triggers = triggers.load(memory_order_relaxed);
+    result.played = played.load(memory_order_relaxed);
+    result.stolen = stolen.load(memory_order_relaxed);
+    result.dropped = dropped.load(memory_order_relaxed);
+    if (result.played > 0) {
+        result.averageLatency = static_cast<double>(latencySum.load(memory_order_relaxed)) / result.played;
+    }
+    result.maxLatency = static_cast<double>(latencyMax.load(memory_order_relaxed));
+    return result;
+}
+
+void AudioSystem::printReport(ostream& out) const {
+    AudioStats result = stats();
+    out << "Audio: " << result.triggers << " triggers, " << result.played << " played, " << result.stolen << " stolen, "
+        << result.dropped << " dropped; latency " << result.averageLatency << " us avg, " << result.maxLatency << " us max" << endl;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+// Sound effects played from a fixed pool of voices on a thread of their own.
+//
+// trigger() is a lock-free push onto a bounded queue and may be called from
+// any thread; it never touches OpenAL. The audio thread drains the queue,
+// picks a voice and starts it. Each effect has a priority and a voice limit:
+// - under its limit it takes a free voice, or steals the lowest-priority,
+//   oldest voice of equal or lower priority;
+// - at its limit it restarts its own oldest voice, so rapid fire overlaps a
+//   few shots instead of cutting each one off.
+// Triggers with nowhere to go are dropped and counted.
+//
+// The buffers are the decoded PCM held by the ResourceCache; nothing is
+// decoded here.
+
+enum SoundEffect {
+    SFX_SHOOT,
+    SFX_HEART,
+    SFX_GAME_OVER,
+    SFX_NAVIGATION,
+    SFX_SELECTION,
+    SFX_COUNT
+};
+
+struct AudioStats {
+    unsigned long long triggers = 0;
+    unsigned long long played = 0;
+    unsigned long long stolen = 0;
+    unsigned long long dropped = 0;
+    //Trigger to play() returning, in microseconds
+    double averageLatency = 0;
+    double maxLatency = 0;
+};
+
+class AudioSystem {
+public:
+    explicit AudioSystem(unsigned voiceCount = 16);
+    ~AudioSystem();
+    AudioSystem(const AudioSystem&) = delete;
+    AudioSystem& operator=(const AudioSystem&) = delete;
+
+    //The buffer must outlive the AudioSystem; a null buffer mutes the effect
+    void setEffect(SoundEffect effect, const sf::SoundBuffer* buffer, int priority, int maxVoices);
+    //False if the queue was full and the sound was dropped
+    bool trigger(SoundEffect effect);
+
+    AudioStats stats() const;
+    void printReport(std::ostream& out) const;
+
+private:
+    struct Trigger {
+        SoundEffect effect = SFX_COUNT;
+        long long queuedAt = 0;
+    };
+
+    //Bounded multi-producer queue: each cell's sequence says whose turn it is
+    struct Cell {
+        std::atomic<size_t> sequence{ 0 };
+        Trigger trigger;
+    };
+
+    struct Effect {
+        std::atomic<const sf::SoundBuffer*> buffer{ nullptr };
+        std::atomic<int> priority{ 0 };
+        std::atomic<int> maxVoices{ 1 };
+    };
+
+    struct Voice {
+        sf::Sound sound;
+        SoundEffect effect = SFX_COUNT;
+        int priority = 0;
+        unsigned long long startedAt = 0;
+    };
+
+    bool pop(Trigger& trigger);
+    void play(const Trigger& trigger);
+    void audioLoop();
+
+    static const size_t QUEUE_SIZE = 256;
+    std::vector<Cell> cells;
+    std::atomic<size_t> enqueuePos{ 0 };
+    size_t dequeuePos = 0;
+
+    Effect effects[SFX_COUNT];
+    std::vector<Voice> voices;
+    unsigned long long voiceStarts = 0;
+
+    std::atomic<unsigned long long> triggers{ 0 };
+    std::atomic<unsigned long long> played{ 0 };
+    std::atomic<unsigned long long> stolen{ 0 };
+    std::atomic<unsigned long long> dropped{ 0 };
+    std::atomic<long long> latencySum{ 0 };
+    std::atomic<long long> latencyMax{ 0 };
+
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    std::atomic<bool> stopping{ false };
+    std::thread thread;
+};
@@ -0,0 +1,540 @@
+// Stress benchmark for the game loop. Each scenario keeps a fixed number of
+// aliens, bullets and bonus hearts on screen (topping them up between ticks,
+// outside the timed region) and times update, collision and render per tick.
+// Results are printed as one JSON object per line with min/median/p99 in
+// microseconds.
+//
+// The final state checksum is printed too, so runs with different --threads
+// values can be checked for identical results.
+//
+// --kernels times the SIMD kernels on their own against the scalar versions
+// and checks that every version gives the same output.
+//
+// --masks runs every scenario twice, on boxes alone and with pixel masks
+// (ellipses standing in for the sprites) checked after the boxes overlap,
+// so the "collision" lines show what the narrow phase costs.
+//
+// --states captures the mixed scenario's state into a rewind ring every tick
+// and restores it into a second game, timing both and checking that the
+// restored game has the same checksum. Afterwards both games step on for
+// as many ticks again, and "continued" says whether their checksums still
+// agree on every one of them, i.e. whether a state holds everything step()
+// reads rather than just what the checksum covers.
+//
+// --scores fills a score store in a scratch directory with 100k to 1M
+// entries spread over the three levels, timing each submit() and how long
+// the writer takes to get them all on disk (appends, syncs and the
+// compactions they trigger). It then times one compaction of the whole
+// store and top(10) reads against the compacted index plus a part-filled
+// journal, and checks the leaderboard and entry count against the scores
+// it submitted.
+//
+// --particles keeps 1k to 100k particles alive, topped up by bursts outside
+// the timed region, and times their update (and batching and drawing with
+// render timing) against a 60 fps frame.
+//
+// Build: g++ -std=c++17 -O2 -pthread bench.cpp game.cpp entities.cpp grid.cpp profiler.cpp jobs.cpp simd.cpp arena.cpp timeline.cpp particles.cpp mask.cpp savestate.cpp mapped_file.cpp scores.cpp -o bench
+// With render timing (needs SFML and a GL context):
+//        g++ -std=c++17 -O2 -pthread -DBENCH_RENDER bench.cpp game.cpp entities.cpp grid.cpp profiler.cpp jobs.cpp simd.cpp arena.cpp timeline.cpp particles.cpp mask.cpp savestate.cpp mapped_file.cpp scores.cpp render.cpp
+//            -lsfml-graphics -lsfml-window -lsfml-system -o bench
+// Usage: bench [--ticks N] [--scenario name] [--max N] [--threads N] [--masks] [--states] [--scores] [--kernels] [--particles]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "game.h"
+#include "particles.h"
+#include "savestate.h"
+#include "scores.h"
+#ifdef BENCH_RENDER
+#include "render.h"
+#endif
+
+using namespace std;
+
+struct Scenario {
+    string name;
+    int aliens;
+    int bullets;
+    int hearts;
+};
+
+struct Summary {
+    double min = 0, median = 0, p99 = 0;
+};
+
+static Summary summarize(vector<double>& values) {
+    Summary summary;
+    if (values.empty()) {
+        return summary;
+    }
+    sort(values.begin(), values.end());
+    summary.min = values.front();
+    summary.median = values[values.size() / 2];
+    summary.p99 = values[min(values.size() - 1, static_cast<size_t>(values.size() * 0.99))];
+    return summary;
+}
+
+static void printSummary(const char* name, vector<double>& values) {
+    Summary summary = summarize(values);
+    cout << ",\"" << name << "_us\":{\"min\":" << summary.min << ",\"median\":" << summary.median << ",\"p99\":" << summary.p99 << "}";
+}
+
+//Refill the stores to the scenario's counts with entities spread over the screen
+static void topUp(Game& game, const Scenario& scenario, GameRng& rng) {
+    const GameConfig& config = game.config;
+    while (game.aliens.size() < static_cast<size_t>(scenario.aliens)) {
+        float x = static_cast<float>(rng.below(WINDOW_WIDTH - static_cast<int>(config.alienWidth)));
+        float y = static_cast<float>(rng.below(WINDOW_HEIGHT)) - config.alienHeight;
+        game.aliens.add(x, y, 0, config.alienSpeed, config.alienWidth, config.alienHeight);
+    }
+    while (game.bullets.size() < static_cast<size_t>(scenario.bullets)) {
+        float x = static_cast<float>(rng.below(WINDOW_WIDTH));
+        float y = static_cast<float>(rng.below(WINDOW_HEIGHT));
+        game.bullets.add(x, y, 0, -BULLET_SPEED, BULLET_WIDTH, BULLET_HEIGHT);
+    }
+    while (game.bonusHearts.size() < static_cast<size_t>(scenario.hearts)) {
+        float x = static_cast<float>(rng.below(WINDOW_WIDTH - static_cast<int>(config.heartWidth)));
+        float y = static_cast<float>(rng.below(WINDOW_HEIGHT)) - config.heartHeight;
+        game.bonusHearts.add(x, y, 0, config.alienSpeed, config.heartWidth, config.heartHeight);
+    }
+    //Keep the run going no matter how many aliens get through
+    game.hearts = MAX_HEARTS;
+    game.over = false;
+}
+
+//A filled ellipse the size of the image, as a stand-in for a sprite's alpha
+static CollisionMask ellipseMask(float width, float height) {
+    const unsigned SIDE = 256;
+    vector<unsigned char> rgba(SIDE * SIDE * 4, 0);
+    for (unsigned y = 0; y < SIDE; y++) {
+        for (unsigned x = 0; x < SIDE; x++) {
+            float dx = (x + 0.5f) / SIDE * 2 - 1;
+            float dy = (y + 0.5f) / SIDE * 2 - 1;
+            rgba[(y * SIDE + x) * 4 + 3] = dx * dx + dy * dy <= 1 ? 255 : 0;
+        }
+    }
+    return buildMask(rgba.data(), SIDE, SIDE, static_cast<int>(width + 0.5f), static_cast<int>(height + 0.5f));
+}
+
+static void runScenario(const Scenario& scenario, int ticks, JobSystem* jobs, const CollisionMasks* masks) {
+    GameConfig config = defaultConfig(Level::MEDIUM);
+    config.maxBullets = max(scenario.bullets, MAX_BULLETS);
+    Game game;
+    resetGame(game, config, 1);
+    Profiler profiler(ticks);
+    game.profiler = &profiler;
+    game.jobs = jobs;
+    game.masks = masks;
+    GameRng rng;
+    rng.seed(42);
+
+#ifdef BENCH_RENDER
+    static sf::RenderTexture target;
+    static bool targetReady = target.create(WINDOW_WIDTH, WINDOW_HEIGHT);
+    SpriteBatch bulletBatch, alienBatch, heartBatch;
+    RenderStats renderStats;
+#endif
+
+    GameInput input;
+    input.fire = true;
+    vector<double> update, collision, render, total, jobMicros;
+    vector<FrameSample> last;
+    for (int tick = 0; tick < ticks; tick++) {
+        topUp(game, scenario, rng);
+
+        profiler.beginFrame();
+        auto start = chrono::steady_clock::now();
+        step(game, TICK_DT, input);
+        double stepMicros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        double renderMicros = 0;
+#ifdef BENCH_RENDER
+        if (targetReady) {
+            ProfileScope scope(&profiler, PHASE_RENDER);
+            renderStats.beginFrame();
+            target.clear();
+            bulletBatch.clear();
+            bulletBatch.addEntities(game.bullets, sf::Color::Green);
+            bulletBatch.draw(target, renderStats);
+            alienBatch.clear();
+            alienBatch.addEntities(game.aliens);
+            alienBatch.draw(target, renderStats);
+            heartBatch.clear();
+            heartBatch.addEntities(game.bonusHearts);
+            heartBatch.draw(target, renderStats);
+            target.display();
+            renderStats.endFrame();
+        }
+#endif
+        profiler.endFrame();
+
+        profiler.recent(1, last);
+        const float* phase = last[0].micros;
+        update.push_back(phase[PHASE_INPUT] + phase[PHASE_SPAWN] + phase[PHASE_MOVE_BULLETS] + phase[PHASE_MOVE_ALIENS] +
+                         phase[PHASE_MOVE_HEARTS] + phase[PHASE_COMPACT]);
+        collision.push_back(phase[PHASE_BROADPHASE] + phase[PHASE_COLLIDE_BULLETS] + phase[PHASE_COLLIDE_PLAYER] + phase[PHASE_COLLIDE_HEARTS]);
+        renderMicros = phase[PHASE_RENDER];
+        render.push_back(renderMicros);
+        total.push_back(stepMicros + renderMicros);
+        if (jobs) {
+            double micros = 0;
+            for (const auto& timing : jobs->tickTimings()) {
+                micros += timing.micros;
+            }
+            jobMicros.push_back(micros);
+        }
+    }
+
+    cout << "{\"scenario\":\"" << scenario.name << "\",\"aliens\":" << scenario.aliens << ",\"bullets\":" << scenario.bullets
+         << ",\"hearts\":" << scenario.hearts << ",\"ticks\":" << ticks << ",\"masks\":" << (masks ? "true" : "false");
+    printSummary("update", update);
+    printSummary("collision", collision);
+#ifdef BENCH_RENDER
+    printSummary("render", render);
+#endif
+    printSummary("tick", total);
+    if (jobs) {
+        cout << ",\"threads\":" << jobs->threadCount();
+        printSummary("jobs", jobMicros);
+    }
+    cout << ",\"checksum\":\"" << hex << gameChecksum(game) << dec << "\"}" << endl;
+}
+
+//Times integrate+cull and one-box-vs-many overlap for each kernel set on the
+//same data; every set must reproduce the scalar output exactly
+static void runKernels(const vector<int>& counts, int ticks) {
+    vector<const SimdKernels*> sets = { &scalarKernels() };
+    if (sseKernels()) sets.push_back(sseKernels());
+    if (avxKernels()) sets.push_back(avxKernels());
+
+    GameRng rng;
+    rng.seed(42);
+    for (int n : counts) {
+        vector<float> x(n), y(n), vx(n), vy(n), w(n, 100.0f), h(n, 100.0f);
+        for (int i = 0; i < n; i++) {
+            x[i] = static_cast<float>(rng.below(WINDOW_WIDTH + 200)) - 100;
+            y[i] = static_cast<float>(rng.below(WINDOW_HEIGHT + 200)) - 100;
+            vx[i] = static_cast<float>(rng.below(200)) - 100;
+            vy[i] = static_cast<float>(rng.below(1200)) - 600;
+        }
+        CullBounds bounds = { 0, static_cast<float>(WINDOW_HEIGHT), 0 };
+        Aabb bullet = { WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f, BULLET_WIDTH, BULLET_HEIGHT };
+
+        double scalarMove = 0, scalarOverlap = 0;
+        vector<float> expectX, expectY;
+        vector<unsigned char> expectAlive, expectBits;
+        for (const SimdKernels* kernels : sets) {
+            vector<float> px, py;
+            vector<unsigned char> alive, bits((n + 7) / 8);
+            vector<double> move, overlap;
+            size_t hits = 0;
+            for (int tick = 0; tick < ticks; tick++) {
+                px = x;
+                py = y;
+                alive.assign(n, 1);
+                auto start = chrono::steady_clock::now();
+                kernels->integrate(px.data(), py.data(), vx.data(), vy.data(), n, TICK_DT);
+                kernels->cull(px.data(), py.data(), w.data(), alive.data(), n, bounds);
+                auto middle = chrono::steady_clock::now();
+                hits = kernels->overlap(bullet, px.data(), py.data(), w.data(), h.data(), n, bits.data());
+                auto end = chrono::steady_clock::now();
+                move.push_back(chrono::duration<double, micro>(middle - start).count());
+                overlap.push_back(chrono::duration<double, micro>(end - middle).count());
+            }
+
+            bool same = true;
+            if (kernels == sets.front()) {
+                expectX = px;
+                expectY = py;
+                expectAlive = alive;
+                expectBits = bits;
+            }
+            else {
+                same = px == expectX && py == expectY && alive == expectAlive && bits == expectBits;
+            }
+            double moveMedian = summarize(move).median;
+            double overlapMedian = summarize(overlap).median;
+            if (kernels == sets.front()) {
+                scalarMove = moveMedian;
+                scalarOverlap = overlapMedian;
+            }
+
+            cout << "{\"kernels\":\"" << kernels->name << "\",\"count\":" << n << ",\"hits\":" << hits;
+            printSummary("move", move);
+            printSummary("overlap", overlap);
+            cout << ",\"move_speedup\":" << (moveMedian > 0 ? scalarMove / moveMedian : 0)
+                 << ",\"overlap_speedup\":" << (overlapMedian > 0 ? scalarOverlap / overlapMedian : 0)
+                 << ",\"matches_scalar\":" << (same ? "true" : "false") << "}" << endl;
+        }
+    }
+}
+
+static void runParticles(int ticks) {
+    const double FRAME_MICROS = 1e6 / 60;
+    ParticleStyle style = { 64, 50.0f, 400.0f, 1.0f, 3.0f, 0xFFC040FFu };
+#ifdef BENCH_RENDER
+    static sf::RenderTexture target;
+    static bool targetReady = target.create(WINDOW_WIDTH, WINDOW_HEIGHT);
+    SpriteBatch batch;
+    RenderStats renderStats;
+#endif
+    GameRng rng;
+    rng.seed(42);
+    for (size_t n : { 1000, 10000, 50000, 100000 }) {
+        //An unreachable budget keeps the adaptive limit out of the measurement
+        ParticleSystem particles(PARTICLE_CAPACITY, 1e9f);
+        vector<double> update, render, total;
+        for (int tick = 0; tick < ticks; tick++) {
+            while (particles.size() < n) {
+                style.count = min<size_t>(64, n - particles.size());
+                particles.burst(static_cast<float>(rng.below(WINDOW_WIDTH)), static_cast<float>(rng.below(WINDOW_HEIGHT)), style);
+            }
+            auto start = chrono::steady_clock::now();
+            particles.update(TICK_DT);
+            auto middle = chrono::steady_clock::now();
+#ifdef BENCH_RENDER
+            if (targetReady) {
+                renderStats.beginFrame();
+                target.clear();
+                batch.clear();
+                batch.addParticles(particles);
+                batch.draw(target, renderStats);
+                target.display();
+                renderStats.endFrame();
+            }
+#endif
+            auto end = chrono::steady_clock::now();
+            update.push_back(chrono::duration<double, micro>(middle - start).count());
+            render.push_back(chrono::duration<double, micro>(end - middle).count());
+            total.push_back(chrono::duration<double, micro>(end - start).count());
+        }
+        cout << "{\"particles\":" << n << ",\"ticks\":" << ticks;
+        printSummary("update", update);
+#ifdef BENCH_RENDER
+        printSummary("render", render);
+#endif
+        double median = summarize(total).median;
+        cout << ",\"frame_share\":" << median / FRAME_MICROS << "}" << endl;
+    }
+}
+
+//Capture into a full-size rewind ring and restore the newest state, at mixed-scenario counts
+static void runScores(int ticks) {
+    const size_t TOP = 10;
+    //Below COMPACT_THRESHOLD, so the reads see an index and a journal
+    const size_t JOURNAL_ENTRIES = COMPACT_THRESHOLD / 2;
+    string directory = (filesystem::temp_directory_path() / "retro-blasters-bench-scores").string();
+    for (int n : { 100000, 300000, 1000000 }) {
+        error_code ignored;
+        filesystem::remove_all(directory, ignored);
+        vector<int> expected[3];
+        GameRng rng;
+        rng.seed(42);
+        vector<double> submit, top;
+        double drainMs = 0, compactMs = 0;
+        bool match = true;
+        size_t total = 0;
+        {
+            ScoreStore store(directory);
+            store.open();
+            auto submitScores = [&](size_t count, vector<double>* times) {
+                for (size_t i = 0; i < count; i++) {
+                    Level level = Level(rng.below(3));
+                    int score = rng.below(1000000);
+                    expected[level].push_back(score);
+                    auto start = chrono::steady_clock::now();
+                    store.submit(level, score, 1, 0);
+                    if (times) {
+                        times->push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+                    }
+                }
+            };
+
+            auto start = chrono::steady_clock::now();
+            submitScores(static_cast<size_t>(n), &submit);
+            store.flush();
+            drainMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+            //A compaction of the whole store, plus one append for flush() to wait on; the
+            //writer handles the request no later than the batch holding that append
+            start = chrono::steady_clock::now();
+            store.requestCompaction();
+            submitScores(1, nullptr);
+            store.flush();
+            compactMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+            submitScores(JOURNAL_ENTRIES, nullptr);
+            store.flush();
+            vector<ScoreEntry> best;
+            for (int tick = 0; tick < ticks; tick++) {
+                Level level = Level(tick % 3);
+                auto readStart = chrono::steady_clock::now();
+                store.top(level, TOP, best);
+                top.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - readStart).count());
+            }
+
+            for (int level = 0; level < 3; level++) {
+                vector<int>& scores = expected[level];
+                size_t keep = min(TOP, scores.size());
+                partial_sort(scores.begin(), scores.begin() + keep, scores.end(), greater<int>());
+                store.top(Level(level), TOP, best);
+                match = match && best.size() == keep;
+                for (size_t i = 0; match && i < keep; i++) {
+                    match = best[i].score == scores[i];
+                }
+            }
+            total = store.totalEntries();
+            match = match && total == expected[0].size() + expected[1].size() + expected[2].size();
+        }
+        filesystem::remove_all(directory, ignored);
+
+        cout << "{\"scores\":" << total << ",\"journal\":" << JOURNAL_ENTRIES << ",\"drain_ms\":" << drainMs << ",\"compact_ms\":" << compactMs;
+        printSummary("submit", submit);
+        printSummary("top", top);
+        cout << ",\"match\":" << (match ? "true" : "false") << "}" << endl;
+    }
+}
+
+static void runStates(const vector<int>& counts, int ticks) {
+    for (int n : counts) {
+        Scenario scenario = { "mixed", n, n / 4, n / 20 };
+        GameConfig config = defaultConfig(Level::MEDIUM);
+        config.maxBullets = max(scenario.bullets, MAX_BULLETS);
+        Game game, restored;
+        resetGame(game, config, 1);
+        resetGame(restored, config, 1);
+        RewindBuffer ring;
+        GameRng rng;
+        rng.seed(42);
+        GameInput input;
+        input.fire = true;
+        //One lap around the ring first, so every slot has grown to size
+        topUp(game, scenario, rng);
+        for (size_t i = 0; i < ring.capacity(); i++) {
+            ring.capture(game);
+        }
+        ring.newest().restore(restored);
+        vector<double> capture, restore;
+        bool match = true;
+        for (int tick = 0; tick < ticks; tick++) {
+            topUp(game, scenario, rng);
+            step(game, TICK_DT, input);
+
+            auto start = chrono::steady_clock::now();
+            ring.capture(game);
+            auto middle = chrono::steady_clock::now();
+            ring.newest().restore(restored);
+            auto end = chrono::steady_clock::now();
+            capture.push_back(chrono::duration<double, micro>(middle - start).count());
+            restore.push_back(chrono::duration<double, micro>(end - middle).count());
+            match = match && gameChecksum(restored) == gameChecksum(game);
+        }
+        //Anything the state leaves out shows up as a divergence once both play on
+        bool continued = true;
+        for (int tick = 0; tick < ticks; tick++) {
+            step(game, TICK_DT, input);
+            step(restored, TICK_DT, input);
+            continued = continued && gameChecksum(restored) == gameChecksum(game);
+        }
+        cout << "{\"states\":\"" << scenario.name << "\",\"aliens\":" << scenario.aliens << ",\"bullets\":" << scenario.bullets
+             << ",\"hearts\":" << scenario.hearts << ",\"ticks\":" << ticks << ",\"bytes\":" << ring.newest().size();
+        printSummary("capture", capture);
+        printSummary("restore", restore);
+        cout << ",\"match\":" << (match ? "true" : "false") << ",\"continued\":" << (continued ? "true" : "false") << "}" << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int ticks = 600;
+    int maxCount = 20000;
+    int threads = 1;
+    bool kernels = false;
+    bool particles = false;
+    bool masks = false;
+    bool states = false;
+    bool scores = false;
+    string only;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--kernels") {
+            kernels = true;
+            continue;
+        }
+        if (arg == "--particles") {
+            particles = true;
+            continue;
+        }
+        if (arg == "--masks") {
+            masks = true;
+            continue;
+        }
+        if (arg == "--states") {
+            states = true;
+            continue;
+        }
+        if (arg == "--scores") {
+            scores = true;
+            continue;
+        }
+        if (i + 1 >= argc) break;
+        if (arg == "--ticks") ticks = max(1, atoi(argv[i + 1]));
+        else if (arg == "--scenario") only = argv[i + 1];
+        else if (arg == "--max") maxCount = atoi(argv[i + 1]);
+        else if (arg == "--threads") threads = max(1, atoi(argv[i + 1]));
+        i++;
+    }
+
+    //Counts scale from tens to tens of thousands
+    vector<int> counts;
+    for (int count : { 10, 100, 1000, 5000, 10000, 20000, 50000 }) {
+        if (count <= maxCount) counts.push_back(count);
+    }
+    if (kernels) {
+        runKernels(counts, ticks);
+        return 0;
+    }
+    if (particles) {
+        runParticles(ticks);
+        return 0;
+    }
+    if (scores) {
+        runScores(ticks);
+        return 0;
+    }
+    if (states) {
+        runStates(counts, ticks);
+        return 0;
+    }
+
+    vector<Scenario> scenarios;
+    for (int n : counts) scenarios.push_back({ "aliens", n, 5, 0 });
+    for (int m : counts) scenarios.push_back({ "bullets", 100, m, 0 });
+    for (int m : counts) scenarios.push_back({ "hearts", 10, 5, m });
+    for (int n : counts) scenarios.push_back({ "mixed", n, n / 4, n / 20 });
+
+    //--threads 1 keeps everything on the calling thread
+    unique_ptr<JobSystem> jobs;
+    if (threads > 1) {
+        jobs.reset(new JobSystem(threads - 1));
+    }
+    GameConfig config = defaultConfig(Level::MEDIUM);
+    CollisionMasks ellipses;
+    ellipses.player = ellipseMask(config.playerWidth, config.playerHeight);
+    ellipses.alien = ellipseMask(config.alienWidth, config.alienHeight);
+    ellipses.heart = ellipseMask(config.heartWidth, config.heartHeight);
+    for (const auto& scenario : scenarios) {
+        if (only.empty() || only == scenario.name) {
+            runScenario(scenario, ticks, jobs.get(), nullptr);
+            if (masks) {
+                runScenario(scenario, ticks, jobs.get(), &ellipses);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include "entities.h"
+#include <algorithm>
+
+using namespace std;
+
+void EntityStore::reserve(size_t capacity) {
+    x.reserve(capacity);
+    y.reserve(capacity);
+    vx.reserve(capacity);
+    vy.reserve(capacity);
+    w.reserve(capacity);
+    h.reserve(capacity);
+    alive.reserve(capacity);
+    slotOf.reserve(capacity);
+    denseOf.reserve(capacity);
+    generation.reserve(capacity);
+    freeSlots.reserve(capacity);
+}
+
+void EntityStore::clear() {
+    //Every live slot becomes free again; bump generations so old handles go stale
+    for (size_t i = 0; i < slotOf.size(); i++) {
+        generation[slotOf[i]]++;
+        freeSlots.push_back(slotOf[i]);
+    }
+    x.clear();
+    y.clear();
+    vx.clear();
+    vy.clear();
+    w.clear();
+    h.clear();
+    alive.clear();
+    slotOf.clear();
+}
+
+void EntityStore::resetTo(size_t count) {
+    size_t slots = max(denseOf.size(), count);
+    denseOf.resize(slots);
+    generation.resize(slots);
+    freeSlots.clear();
+    for (size_t slot = 0; slot < slots; slot++) {
+        //Bumped for free slots too, which costs nothing and keeps the loop simple
+        generation[slot]++;
+        if (slot < count) {
+            denseOf[slot] = static_cast<unsigned>(slot);
+        }
+        else {
+            freeSlots.push_back(static_cast<unsigned>(slot));
+        }
+    }
+    slotOf.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        slotOf[i] = static_cast<unsigned>(i);
+    }
+    x.resize(count);
+    y.resize(count);
+    vx.resize(count);
+    vy.resize(count);
+    w.resize(count);
+    h.resize(count);
+    alive.resize(count);
+}
+
+EntityHandle EntityStore::add(float px, float py, float velX, float velY, float width, float height) {
+    unsigned slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else {
+        slot = static_cast<unsigned>(denseOf.size());
+        denseOf.push_back(0);
+        generation.push_back(0);
+    }
+    denseOf[slot] = static_cast<unsigned>(x.size());
+
+    x.push_back(px);
+    y.push_back(py);
+    vx.push_back(velX);
+    vy.push_back(velY);
+    w.push_back(width);
+    h.push_back(height);
+    alive.push_back(1);
+    slotOf.push_back(slot);
+
+    EntityHandle handle;
+    handle.slot = slot;
+    handle.generation = generation[slot];
+    return handle;
+}
+
+size_t EntityStore::countAlive() const {
+    size_t count = 0;
+    for (unsigned char a : alive) {
+        count += a;
+    }
+    return count;
+}
+
+void EntityStore::removeAt(size_t index) {
+    size_t last = x.size() - 1;
+    unsigned slot = slotOf[index];
+    generation[slot]++;
+    freeSlots.push_back(slot);
+
+    if (index != last) {
+        x[index] = x[last];
+        y[index] = y[last];
+        vx[index] = vx[last];
+        vy[index] = vy[last];
+        w[index] = w[last];
+        h[index] = h[last];
+        alive[index] = alive[last];
+        slotOf[index] = slotOf[last];
+        denseOf[slotOf[index]] = static_cast<unsigned>(index);
+    }
+    x.pop_back();
+    y.pop_back();
+    vx.pop_back();
+    vy.pop_back();
+    w.pop_back();
+    h.pop_back();
+    alive.pop_back();
+    slotOf.pop_back();
+}
+
+void EntityStore::removeDead() {
+    size_t i = 0;
+    while (i < x.size()) {
+        if (alive[i]) {
+            i++;
+        }
+        else {
+            removeAt(i);
+        }
+    }
+}
+
+EntityHandle EntityStore::handleOf(size_t index) const {
+    EntityHandle handle;
+    handle.slot = slotOf[index];
+    handle.generation = generation[handle.slot];
+    return handle;
+}
+
+long EntityStore::indexOf(EntityHandle handle) const {
+    if (handle.slot >= generation.size() || generation[handle.slot] != handle.generation) {
+        return -1;
+    }
+    return static_cast<long>(denseOf[handle.slot]);
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Dense struct-of-arrays storage for one kind of entity. Each field lives in
+// its own contiguous array so the hot loops only touch the data they need.
+// Removal is swap-and-pop, so dense indices move around; hold on to an
+// EntityHandle if an entity has to be found again later.
+
+struct EntityHandle {
+    unsigned slot = 0;
+    unsigned generation = 0;
+};
+
+struct EntityStore {
+    //Dense arrays, all the same length
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;
+    std::vector<float> w, h;
+    std::vector<unsigned char> alive;
+    std::vector<unsigned> slotOf;
+
+    //Handle bookkeeping, indexed by slot
+    std::vector<unsigned> denseOf;
+    std::vector<unsigned> generation;
+    std::vector<unsigned> freeSlots;
+
+    size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+
+    void reserve(size_t capacity);
+    void clear();
+    //Resizes to count entities in slots 0..count-1 with every old handle stale,
+    //in one pass over the bookkeeping; the field values are left for the caller
+    //to fill in (e.g. restoring a saved state)
+    void resetTo(size_t count);
+    EntityHandle add(float px, float py, float velX, float velY, float width, float height);
+    void kill(size_t index) { alive[index] = 0; }
+    size_t countAlive() const;
+
+    //Swap-and-pop every entity whose alive flag is cleared
+    void removeDead();
+
+    EntityHandle handleOf(size_t index) const;
+    //Dense index of a handle, or -1 if the entity is gone
+    long indexOf(EntityHandle handle) const;
+
+private:
+    void removeAt(size_t index);
+};
@@ -0,0 +1,376 @@
+#include "game.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+using namespace std;
+
+float levelAlienSpeed(Level level) {
+    switch (level) {
+    case Level::MEDIUM:
+        return 480.0f;
+    case Level::HARD:
+        return 600.0f;
+    default:
+        return 360.0f;
+    }
+}
+
+GameConfig defaultConfig(Level level) {
+    GameConfig config;
+    config.level = level;
+    config.alienSpeed = levelAlienSpeed(level);
+    return config;
+}
+
+void GameRng::seed(unsigned long long value) {
+    //Zero would lock xorshift at zero forever
+    state = value ? value : 0x9E3779B97F4A7C15ull;
+}
+
+unsigned GameRng::next() {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return static_cast<unsigned>((state * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+static const unsigned NO_HIT = 0xFFFFFFFFu;
+
+//Below this many entities a pass is not worth handing to the job system
+static const size_t PARALLEL_MIN_COUNT = 2048;
+static const size_t PARALLEL_GRAIN = 1024;
+
+template <class Fn>
+static void forRange(Game& game, const char* name, size_t count, Fn& fn) {
+    if (game.jobs && count >= PARALLEL_MIN_COUNT) {
+        game.jobs->parallelFor(name, count, PARALLEL_GRAIN, fn);
+    }
+    else {
+        fn(0, count);
+    }
+}
+
+void resetGame(Game& game, const GameConfig& config, unsigned long long seed) {
+    game.config = config;
+    //Size the stores up front so a normal game never grows them mid-play
+    game.bullets.reserve(config.maxBullets);
+    game.aliens.reserve(ALIEN_POOL_SIZE);
+    game.bonusHearts.reserve(HEART_POOL_SIZE);
+    //An entity smaller than a cell touches at most four cells
+    game.alienGrid.reserve(ALIEN_POOL_SIZE * 4);
+    game.heartGrid.reserve(HEART_POOL_SIZE * 4);
+    game.effects.reserve(EFFECT_POOL_SIZE);
+    game.playerX = WINDOW_WIDTH / 2 - config.playerWidth / 2;
+    game.playerY = WINDOW_HEIGHT - config.playerHeight - 10;
+    game.bullets.clear();
+    game.aliens.clear();
+    game.bonusHearts.clear();
+    game.effects.clear();
+    game.score = 0;
+    game.hearts = MAX_HEARTS;
+    game.timelineCursor = 0;
+    game.timelineStart = 0;
+    game.shootTicks = 0;
+    game.tick = 0;
+    game.over = false;
+    game.seed = seed;
+    game.rng.seed(seed);
+}
+
+const SpawnTimeline& activeTimeline(const Game& game) {
+    return game.timeline ? *game.timeline : defaultTimeline();
+}
+
+//Random left edge that keeps a span of this width on screen
+static float randomLeft(Game& game, float span) {
+    int room = WINDOW_WIDTH - static_cast<int>(span);
+    return room > 0 ? static_cast<float>(game.rng.below(room)) : 0.0f;
+}
+
+//Adds a whole group in one go, growing the store at most once
+static void spawnGroup(Game& game, const SpawnEvent& event) {
+    const GameConfig& config = game.config;
+    bool heart = event.kind == SPAWN_HEART;
+    EntityStore& store = heart ? game.bonusHearts : game.aliens;
+    float width = heart ? config.heartWidth : config.alienWidth;
+    float height = heart ? config.heartHeight : config.alienHeight;
+    float speed = config.alienSpeed * event.speed;
+    float spacing = event.spacing > 0 ? event.spacing : (event.pattern == PATTERN_COLUMN ? height : width);
+    size_t count = event.count;
+    if (store.x.capacity() < store.size() + count) {
+        store.reserve(max(store.size() + count, store.x.capacity() * 2));
+    }
+
+    float maxLeft = static_cast<float>(WINDOW_WIDTH) - width;
+    switch (event.pattern) {
+    case PATTERN_ROW: {
+        float span = width + spacing * (count - 1);
+        float left = event.x >= 0 ? event.x : randomLeft(game, span);
+        for (size_t i = 0; i < count; i++) {
+            store.add(min(left + spacing * i, maxLeft), -height, 0, speed, width, height);
+        }
+        break;
+    }
+    case PATTERN_COLUMN: {
+        float left = event.x >= 0 ? min(event.x, maxLeft) : randomLeft(game, width);
+        for (size_t i = 0; i < count; i++) {
+            store.add(left, -height - spacing * i, 0, speed, width, height);
+        }
+        break;
+    }
+    case PATTERN_VEE: {
+        //Members pair up behind the leader, one step further back and out each pair
+        float wing = spacing * (count / 2);
+        float center = event.x >= 0 ? event.x : wing + randomLeft(game, width + 2 * wing);
+        for (size_t i = 0; i < count; i++) {
+            float rank = static_cast<float>((i + 1) / 2);
+            float side = i % 2 == 1 ? -1.0f : 1.0f;
+            float left = max(0.0f, min(center + side * rank * spacing, maxLeft));
+            store.add(left, -height - rank * spacing, 0, speed, width, height);
+        }
+        break;
+    }
+    default:
+        //Staggered vertically so a random group does not land in one clump
+        for (size_t i = 0; i < count; i++) {
+            float left = event.x >= 0 ? min(event.x, maxLeft) : randomLeft(game, width);
+            store.add(left, -height - spacing * i, 0, speed, width, height);
+        }
+        break;
+    }
+}
+
+GameEvents step(Game& game, float dt, const GameInput& input) {
+    GameEvents events;
+    if (game.over) {
+        return events;
+    }
+    const GameConfig& config = game.config;
+    const CollisionMasks* masks = game.masks && !game.masks->empty() ? game.masks : nullptr;
+    game.tick++;
+    game.arena.reset();
+    game.effects.clear();
+    if (game.jobs) {
+        game.jobs->beginTick();
+    }
+
+    // Player movement
+    {
+        ProfileScope scope(game.profiler, PHASE_INPUT);
+        float playerStep = PLAYER_SPEED * dt;
+        if (input.left && game.playerX > 0) {
+            game.playerX -= playerStep;
+        }
+        if (input.right && game.playerX + config.playerWidth < WINDOW_WIDTH) {
+            game.playerX += playerStep;
+        }
+        if (input.up && game.playerY > 0) {
+            game.playerY -= playerStep;
+        }
+        if (input.down && game.playerY + config.playerHeight < WINDOW_HEIGHT) {
+            game.playerY += playerStep;
+        }
+    }
+
+    EntityStore& bullets = game.bullets;
+    EntityStore& aliens = game.aliens;
+    EntityStore& bonusHearts = game.bonusHearts;
+    const SimdKernels& kernels = simdKernels();
+
+    {
+        ProfileScope scope(game.profiler, PHASE_SPAWN);
+
+        // Spawn aliens and hearts due on this tick
+        const SpawnTimeline& timeline = activeTimeline(game);
+        const vector<SpawnEvent>& spawns = timeline.events;
+        while (true) {
+            while (game.timelineCursor < spawns.size() && spawns[game.timelineCursor].tick <= game.tick - game.timelineStart) {
+                spawnGroup(game, spawns[game.timelineCursor++]);
+            }
+            if (timeline.loopTicks == 0 || game.timelineCursor < spawns.size() || game.tick - game.timelineStart < timeline.loopTicks) {
+                break;
+            }
+            game.timelineStart += timeline.loopTicks;
+            game.timelineCursor = 0;
+        }
+
+        // Shooting bullets
+        game.shootTicks++;
+        if (input.fire && bullets.size() < static_cast<size_t>(config.maxBullets) && game.shootTicks >= SHOOT_TICKS) {
+            bullets.add(game.playerX + config.playerWidth / 2 - 2.5f, game.playerY, 0, -BULLET_SPEED, BULLET_WIDTH, BULLET_HEIGHT);
+            game.effects.push_back({ EFFECT_SHOT, game.playerX + config.playerWidth / 2, game.playerY });
+            game.shootTicks = 0;
+            events.shotsFired++;
+        }
+    }
+
+    // Move bullets
+    {
+        ProfileScope scope(game.profiler, PHASE_MOVE_BULLETS);
+        CullBounds bounds = { 0, INFINITY, -INFINITY };
+        auto moveBullets = [&](size_t begin, size_t end) {
+            kernels.integrate(bullets.x.data() + begin, bullets.y.data() + begin, bullets.vx.data() + begin, bullets.vy.data() + begin, end - begin, dt);
+            kernels.cull(bullets.x.data() + begin, bullets.y.data() + begin, bullets.w.data() + begin, bullets.alive.data() + begin, end - begin, bounds);
+        };
+        forRange(game, "move_bullets", bullets.size(), moveBullets);
+    }
+
+    // Move aliens
+    {
+        ProfileScope scope(game.profiler, PHASE_MOVE_ALIENS);
+        atomic<int> escaped(0);
+        CullBounds bounds = { -INFINITY, static_cast<float>(WINDOW_HEIGHT), 0 };
+        auto moveAliens = [&](size_t begin, size_t end) {
+            kernels.integrate(aliens.x.data() + begin, aliens.y.data() + begin, aliens.vx.data() + begin, aliens.vy.data() + begin, end - begin, dt);
+            escaped += static_cast<int>(kernels.cull(aliens.x.data() + begin, aliens.y.data() + begin, aliens.w.data() + begin, aliens.alive.data() + begin, end - begin, bounds));
+        };
+        forRange(game, "move_aliens", aliens.size(), moveAliens);
+        game.hearts -= escaped;
+        events.aliensEscaped += escaped;
+    }
+
+    //Move hearts
+    {
+        ProfileScope scope(game.profiler, PHASE_MOVE_HEARTS);
+        CullBounds bounds = { -INFINITY, static_cast<float>(WINDOW_HEIGHT), -INFINITY };
+        auto moveHearts = [&](size_t begin, size_t end) {
+            kernels.integrate(bonusHearts.x.data() + begin, bonusHearts.y.data() + begin, bonusHearts.vx.data() + begin, bonusHearts.vy.data() + begin, end - begin, dt);
+            kernels.cull(bonusHearts.x.data() + begin, bonusHearts.y.data() + begin, bonusHearts.w.data() + begin, bonusHearts.alive.data() + begin, end - begin, bounds);
+        };
+        forRange(game, "move_hearts", bonusHearts.size(), moveHearts);
+    }
+
+    // Remove whatever left the screen
+    {
+        ProfileScope scope(game.profiler, PHASE_COMPACT);
+        bullets.removeDead();
+        aliens.removeDead();
+        bonusHearts.removeDead();
+    }
+
+    // Check collisions: broad phase on the grids, AABB only for pairs sharing a cell,
+    // then the pixel masks (if any) for pairs whose boxes overlap
+    {
+        ProfileScope scope(game.profiler, PHASE_BROADPHASE);
+        game.alienGrid.build(aliens);
+        game.heartGrid.build(bonusHearts);
+    }
+
+    {
+        ProfileScope scope(game.profiler, PHASE_COLLIDE_BULLETS);
+
+        //Each bullet takes the lowest-indexed alien it overlaps
+        auto firstHit = [&](size_t b) {
+            Aabb box = { bullets.x[b], bullets.y[b], bullets.w[b], bullets.h[b] };
+            long hit = masks
+                ? game.alienGrid.firstOverlap(box, aliens.alive.data(), [&](unsigned a) {
+                      return maskOverlapsBox(masks->alien, aliens.x[a], aliens.y[a], box);
+                  })
+                : game.alienGrid.firstOverlap(box, aliens.alive.data());
+            return hit < 0 ? NO_HIT : static_cast<unsigned>(hit);
+        };
+
+        //Candidates are searched in parallel against the aliens alive at the start of the pass
+        unsigned* bulletHits = game.arena.allocArray<unsigned>(bullets.size());
+        auto findHits = [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; b++) {
+                bulletHits[b] = firstHit(b);
+            }
+        };
+        forRange(game, "collide_bullets", bullets.size(), findHits);
+
+        //Merge in bullet order. If an earlier bullet took this bullet's alien,
+        //search again, which gives the same result as a fully serial pass.
+        for (size_t b = 0; b < bullets.size(); b++) {
+            unsigned hit = bulletHits[b];
+            if (hit != NO_HIT && !aliens.alive[hit]) {
+                hit = firstHit(b);
+            }
+            if (hit != NO_HIT) {
+                bullets.alive[b] = 0;
+                aliens.alive[hit] = 0;
+                game.effects.push_back({ EFFECT_ALIEN_DESTROYED, aliens.x[hit] + aliens.w[hit] / 2, aliens.y[hit] + aliens.h[hit] / 2 });
+                game.score++;
+                events.aliensDestroyed++;
+            }
+        }
+    }
+
+    Aabb player = { game.playerX, game.playerY, config.playerWidth, config.playerHeight };
+
+    // Collision with player (alien collides with spaceship)
+    {
+        ProfileScope scope(game.profiler, PHASE_COLLIDE_PLAYER);
+        game.alienGrid.queryOverlaps(player, [&](unsigned a) {
+            if (aliens.alive[a] && (!masks || masksOverlap(masks->player, player.x, player.y, masks->alien, aliens.x[a], aliens.y[a]))) {
+                aliens.alive[a] = 0;
+                game.effects.push_back({ EFFECT_PLAYER_HIT, aliens.x[a] + aliens.w[a] / 2, aliens.y[a] + aliens.h[a] / 2 });
+                game.hearts--;
+                events.playerHits++;
+            }
+        });
+    }
+
+    //Collision of hearts with player
+    {
+        ProfileScope scope(game.profiler, PHASE_COLLIDE_HEARTS);
+        game.heartGrid.queryOverlaps(player, [&](unsigned i) {
+            if (bonusHearts.alive[i] && (!masks || masksOverlap(masks->player, player.x, player.y, masks->heart, bonusHearts.x[i], bonusHearts.y[i]))) {
+                bonusHearts.alive[i] = 0;
+                if (game.hearts < MAX_HEARTS) {
+                    game.hearts++;
+                    events.heartsCollected++;
+                    game.effects.push_back({ EFFECT_HEART_COLLECTED, bonusHearts.x[i] + bonusHearts.w[i] / 2, bonusHearts.y[i] + bonusHearts.h[i] / 2 });
+                }
+            }
+        });
+    }
+
+    if (game.hearts <= 0) {
+        game.over = true;
+        events.gameOver = true;
+    }
+    return events;
+}
+
+void hashBytes(unsigned long long& hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+}
+
+template <class T>
+static void hashValue(unsigned long long& hash, const T& value) {
+    hashBytes(hash, &value, sizeof(value));
+}
+
+static void hashStore(unsigned long long& hash, const EntityStore& store) {
+    hashValue(hash, store.size());
+    if (!store.empty()) {
+        hashBytes(hash, store.x.data(), store.size() * sizeof(float));
+        hashBytes(hash, store.y.data(), store.size() * sizeof(float));
+        hashBytes(hash, store.vx.data(), store.size() * sizeof(float));
+        hashBytes(hash, store.vy.data(), store.size() * sizeof(float));
+        hashBytes(hash, store.alive.data(), store.size());
+    }
+}
+
+unsigned long long gameChecksum(const Game& game) {
+    unsigned long long hash = FNV_OFFSET_BASIS;
+    hashValue(hash, game.tick);
+    hashValue(hash, game.playerX);
+    hashValue(hash, game.playerY);
+    hashValue(hash, game.score);
+    hashValue(hash, game.hearts);
+    hashValue(hash, game.timelineCursor);
+    hashValue(hash, game.timelineStart);
+    hashValue(hash, game.shootTicks);
+    hashValue(hash, game.rng.state);
+    hashStore(hash, game.bullets);
+    hashStore(hash, game.aliens);
+    hashStore(hash, game.bonusHearts);
+    return hash;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <vector>
+#include "arena.h"
+#include "entities.h"
+#include "grid.h"
+#include "jobs.h"
+#include "mask.h"
+#include "profiler.h"
+#include "timeline.h"
+
+// Game rules, independent of SFML. Everything in here runs without a window,
+// so the same code drives the real game, headless soak runs and profiling.
+
+const int WINDOW_WIDTH = 1920;
+const int WINDOW_HEIGHT = 1080;
+
+//Fixed simulation rate; speeds below are in pixels per second
+const int TICK_RATE = 60;
+const float TICK_DT = 1.0f / TICK_RATE;
+
+const float PLAYER_SPEED = 960.0f;
+const float BULLET_SPEED = 900.0f;
+const float BULLET_WIDTH = 2.0f;
+const float BULLET_HEIGHT = 30.0f;
+const float SHOOT_INTERVAL = 0.2f;
+const int MAX_BULLETS = 5;
+const float ALIEN_SPAWN_INTERVAL = 2.0f;
+const int MAX_HEARTS = 3;
+const float HEART_SPAWN_INTERVAL = 7.0f;
+
+//Timers count whole ticks so a run is reproducible
+const int SHOOT_TICKS = static_cast<int>(SHOOT_INTERVAL * TICK_RATE + 0.5f);
+const int ALIEN_SPAWN_TICKS = static_cast<int>(ALIEN_SPAWN_INTERVAL * TICK_RATE + 0.5f);
+const int HEART_SPAWN_TICKS = static_cast<int>(HEART_SPAWN_INTERVAL * TICK_RATE + 0.5f);
+
+//Store capacities reserved per game; only stress runs ever go past them
+const int ALIEN_POOL_SIZE = 64;
+const int HEART_POOL_SIZE = 16;
+const int EFFECT_POOL_SIZE = 64;
+
+//Levels and speed constants
+enum Level { EASY, MEDIUM, HARD };
+
+float levelAlienSpeed(Level level);
+
+//Sizes come from the scaled textures when a window exists
+struct GameConfig {
+    Level level = EASY;
+    float alienSpeed = 360.0f;
+    float playerWidth = 100.0f, playerHeight = 100.0f;
+    float alienWidth = 100.0f, alienHeight = 100.0f;
+    float heartWidth = 40.0f, heartHeight = 40.0f;
+    //Live bullet cap; stress runs lift it
+    int maxBullets = MAX_BULLETS;
+};
+
+GameConfig defaultConfig(Level level);
+
+//Small deterministic generator (xorshift64*); every game owns its own
+struct GameRng {
+    unsigned long long state = 1;
+
+    void seed(unsigned long long value);
+    unsigned next();
+    int below(int bound) { return static_cast<int>(next() % static_cast<unsigned>(bound)); }
+};
+
+//Input sampled once per tick
+struct GameInput {
+    bool left = false;
+    bool right = false;
+    bool up = false;
+    bool down = false;
+    bool fire = false;
+};
+
+//What happened during a tick, so the front end can play sounds etc.
+struct GameEvents {
+    int shotsFired = 0;
+    int aliensDestroyed = 0;
+    int aliensEscaped = 0;
+    int playerHits = 0;
+    int heartsCollected = 0;
+    bool gameOver = false;
+};
+
+//Where something worth showing happened; purely visual, never read back by step()
+enum EffectKind {
+    EFFECT_SHOT,
+    EFFECT_ALIEN_DESTROYED,
+    EFFECT_PLAYER_HIT,
+    EFFECT_HEART_COLLECTED
+};
+
+struct GameEffect {
+    EffectKind kind;
+    //Centre of the bullet, alien or heart involved
+    float x, y;
+};
+
+struct Game {
+    GameConfig config;
+    float playerX = 0, playerY = 0;
+    EntityStore bullets;
+    EntityStore aliens;
+    EntityStore bonusHearts;
+    //Broad-phase grids, rebuilt every tick
+    UniformGrid alienGrid;
+    UniformGrid heartGrid;
+    int score = 0;
+    int hearts = MAX_HEARTS;
+    //Next event of the spawn timeline and the tick its current pass started
+    size_t timelineCursor = 0;
+    unsigned long long timelineStart = 0;
+    int shootTicks = 0;
+    unsigned long long tick = 0;
+    unsigned long long seed = 1;
+    GameRng rng;
+    bool over = false;
+    //Effects of the last tick, cleared at the start of step(); not in the checksum
+    std::vector<GameEffect> effects;
+    //Scratch memory for one tick, reset at the start of step()
+    FrameArena arena;
+    //Optional; phase timings of each step are added to the current frame
+    Profiler* profiler = nullptr;
+    //Optional; large movement and collision passes are split across its threads
+    JobSystem* jobs = nullptr;
+    //Optional wave script; the built-in alien and heart clocks when null
+    const SpawnTimeline* timeline = nullptr;
+    //Optional pixel masks checked after the boxes overlap; boxes alone when null
+    const CollisionMasks* masks = nullptr;
+};
+
+void resetGame(Game& game, const GameConfig& config, unsigned long long seed = 1);
+//The timeline step() follows: game.timeline, or the built-in one
+const SpawnTimeline& activeTimeline(const Game& game);
+//Advances one tick; dt should be TICK_DT since the timers count ticks
+GameEvents step(Game& game, float dt, const GameInput& input);
+//FNV-1a over everything that affects future ticks
+unsigned long long gameChecksum(const Game& game);
+//One FNV-1a step over a block of bytes; start from FNV_OFFSET_BASIS
+const unsigned long long FNV_OFFSET_BASIS = 0xCBF29CE484222325ull;
+void hashBytes(unsigned long long& hash, const void* data, size_t size);
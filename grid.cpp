@@ -0,0 +1,89 @@
+#include "grid.h"
+#include "game.h"
+
+using namespace std;
+
+UniformGrid::UniformGrid() : UniformGrid(static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT), GRID_CELL_SIZE) {
+}
+
+UniformGrid::UniformGrid(float width, float height, float cell) {
+    cellSize = cell;
+    cols = static_cast<int>(width / cell) + (static_cast<int>(width) % static_cast<int>(cell) ? 1 : 0);
+    rows = static_cast<int>(height / cell) + (static_cast<int>(height) % static_cast<int>(cell) ? 1 : 0);
+    cellStart.assign(cols * rows + 1, 0);
+    cursor.assign(cols * rows, 0);
+}
+
+static int clampCell(float value, float cellSize, int count) {
+    int cell = static_cast<int>(value / cellSize);
+    if (value < 0 || cell < 0) return 0;
+    if (cell >= count) return count - 1;
+    return cell;
+}
+
+void UniformGrid::cellRange(float x, float y, float w, float h, int& c0, int& r0, int& c1, int& r1) const {
+    c0 = clampCell(x, cellSize, cols);
+    r0 = clampCell(y, cellSize, rows);
+    c1 = clampCell(x + w, cellSize, cols);
+    r1 = clampCell(y + h, cellSize, rows);
+}
+
+void UniformGrid::reserve(size_t count) {
+    entries.reserve(count);
+    entryX.reserve(count);
+    entryY.reserve(count);
+    entryW.reserve(count);
+    entryH.reserve(count);
+}
+
+void UniformGrid::build(const EntityStore& store) {
+    if (store.empty()) {
+        entries.clear();
+        return;
+    }
+    int cells = cols * rows;
+    fill(cellStart.begin(), cellStart.end(), 0);
+
+    //Count how many entries land in each cell
+    for (size_t i = 0; i < store.size(); i++) {
+        if (!store.alive[i]) continue;
+        int c0, r0, c1, r1;
+        cellRange(store.x[i], store.y[i], store.w[i], store.h[i], c0, r0, c1, r1);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                cellStart[r * cols + c + 1]++;
+            }
+        }
+    }
+
+    //Prefix sum into offsets
+    for (int cell = 0; cell < cells; cell++) {
+        cellStart[cell + 1] += cellStart[cell];
+    }
+    entries.resize(cellStart[cells]);
+    entryX.resize(entries.size());
+    entryY.resize(entries.size());
+    entryW.resize(entries.size());
+    entryH.resize(entries.size());
+    for (int cell = 0; cell < cells; cell++) {
+        cursor[cell] = cellStart[cell];
+    }
+
+    //Scatter; indices stay ascending inside each cell
+    for (size_t i = 0; i < store.size(); i++) {
+        if (!store.alive[i]) continue;
+        float x = store.x[i], y = store.y[i], w = store.w[i], h = store.h[i];
+        int c0, r0, c1, r1;
+        cellRange(x, y, w, h, c0, r0, c1, r1);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                unsigned entry = cursor[r * cols + c]++;
+                entries[entry] = static_cast<unsigned>(i);
+                entryX[entry] = x;
+                entryY[entry] = y;
+                entryW[entry] = w;
+                entryH[entry] = h;
+            }
+        }
+    }
+}
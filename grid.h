@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "entities.h"
+#include "simd.h"
+
+// Uniform-grid broad phase over the playfield. Rebuilt every tick with a
+// counting sort into flat arrays, so after warm-up a rebuild allocates
+// nothing. Entities that straddle cells are listed in each cell they touch,
+// and anything outside the playfield is clamped into the border cells.
+// Each entry also keeps a copy of its entity's box, so a cell's boxes sit
+// next to each other and can be tested several at a time.
+
+const float GRID_CELL_SIZE = 128.0f;
+const unsigned QUERY_BLOCK = 64;
+
+struct UniformGrid {
+    int cols = 0, rows = 0;
+    float cellSize = GRID_CELL_SIZE;
+    std::vector<unsigned> cellStart;   // cols * rows + 1 offsets into entries
+    std::vector<unsigned> entries;     // dense entity indices, grouped by cell
+    std::vector<float> entryX, entryY, entryW, entryH;
+    std::vector<unsigned> cursor;
+
+    UniformGrid();
+    UniformGrid(float width, float height, float cell);
+
+    //Room for this many entries before build() has to grow anything
+    void reserve(size_t count);
+    void build(const EntityStore& store);
+
+    //Calls visit(index) for every entity sharing a cell with the box.
+    //An entity spanning several cells may be visited more than once.
+    template <class Visit>
+    void query(float x, float y, float w, float h, Visit&& visit) const {
+        if (entries.empty()) return;
+        int c0, r0, c1, r1;
+        cellRange(x, y, w, h, c0, r0, c1, r1);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                int cell = r * cols + c;
+                for (unsigned i = cellStart[cell]; i < cellStart[cell + 1]; i++) {
+                    visit(entries[i]);
+                }
+            }
+        }
+    }
+
+    //Calls visit(index) only for entities whose box overlaps this one, using
+    //the SIMD overlap kernel on each cell's boxes. Boxes are as of build().
+    template <class Visit>
+    void queryOverlaps(const Aabb& box, Visit&& visit) const {
+        if (entries.empty()) return;
+        const SimdKernels& kernels = simdKernels();
+        unsigned char bits[QUERY_BLOCK / 8];
+        int c0, r0, c1, r1;
+        cellRange(box.x, box.y, box.w, box.h, c0, r0, c1, r1);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                int cell = r * cols + c;
+                for (unsigned start = cellStart[cell]; start < cellStart[cell + 1]; start += QUERY_BLOCK) {
+                    unsigned count = std::min<unsigned>(QUERY_BLOCK, cellStart[cell + 1] - start);
+                    if (kernels.overlap(box, &entryX[start], &entryY[start], &entryW[start], &entryH[start], count, bits) == 0) continue;
+                    for (unsigned byte = 0; byte * 8 < count; byte++) {
+                        for (unsigned mask = bits[byte], lane = 0; mask; mask >>= 1, lane++) {
+                            if (mask & 1) visit(entries[start + byte * 8 + lane]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //Lowest index whose box overlaps this one, whose alive flag is set and
+    //that accept(index) takes (a narrow-phase test), or -1. Stops scanning a
+    //cell at its first accepted hit, since indices ascend per cell.
+    template <class Accept>
+    long firstOverlap(const Aabb& box, const unsigned char* alive, Accept&& accept) const {
+        if (entries.empty()) return -1;
+        const SimdKernels& kernels = simdKernels();
+        unsigned char bits[QUERY_BLOCK / 8];
+        unsigned best = ~0u;
+        int c0, r0, c1, r1;
+        cellRange(box.x, box.y, box.w, box.h, c0, r0, c1, r1);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                int cell = r * cols + c;
+                bool done = false;
+                for (unsigned start = cellStart[cell]; start < cellStart[cell + 1] && !done && entries[start] < best; start += QUERY_BLOCK) {
+                    unsigned count = std::min<unsigned>(QUERY_BLOCK, cellStart[cell + 1] - start);
+                    if (kernels.overlap(box, &entryX[start], &entryY[start], &entryW[start], &entryH[start], count, bits) == 0) continue;
+                    for (unsigned byte = 0; byte * 8 < count && !done; byte++) {
+                        for (unsigned mask = bits[byte], lane = 0; mask; mask >>= 1, lane++) {
+                            unsigned index = entries[start + byte * 8 + lane];
+                            if ((mask & 1) && alive[index] && accept(index)) {
+                                best = std::min(best, index);
+                                done = true;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return best == ~0u ? -1 : static_cast<long>(best);
+    }
+
+    long firstOverlap(const Aabb& box, const unsigned char* alive) const {
+        return firstOverlap(box, alive, [](unsigned) { return true; });
+    }
+
+    void cellRange(float x, float y, float w, float h, int& c0, int& r0, int& c1, int& r1) const;
+};
@@ -0,0 +1,424 @@
+// Headless driver: runs the simulation core with no window, as fast as the CPU
+// allows, for soak tests, profiling and replay checks on display-less machines.
+//
+// Build: g++ -std=c++17 -O2 headless.cpp game.cpp entities.cpp grid.cpp profiler.cpp replay.cpp jobs.cpp simd.cpp arena.cpp timeline.cpp mask.cpp savestate.cpp mapped_file.cpp -pthread -o headless
+// Add -DALLOC_DEBUG to count heap allocations and report ticks that still allocate after warm-up.
+// Usage: headless [--ticks N] [--level easy|medium|hard] [--seed N] [--waves script.txt]
+//                 [--profile out.csv] [--record out.rep] [--replay in.rep]
+//                 [--state in.state] [--save-state out.state]
+//
+// --state starts from a saved game state (e.g. a late, crowded wave) instead
+// of a fresh game, so profiling can jump straight to it; --save-state writes
+// the state reached after --ticks. Games after the first start fresh as usual.
+//
+// Batch mode plays many independent games with the bot, spread over every core,
+// and prints a balancing report per parameter set:
+//        headless --batch N [--levels easy,medium,hard] [--speeds 360,480] [--spawn-intervals 2,1.5]
+//                 [--max-ticks N] [--threads N] [--seed N] [--waves script.txt] [--csv out.csv]
+// Every combination of level, speed and spawn interval plays N games, seeded
+// seed, seed+1, ... so two runs with the same arguments give the same report.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "game.h"
+#include "jobs.h"
+#include "replay.h"
+#include "savestate.h"
+
+using namespace std;
+
+//Simple scripted player: follow the lowest alien and keep firing
+static GameInput botInput(const Game& game) {
+    GameInput input;
+    input.fire = true;
+    const EntityStore& aliens = game.aliens;
+    long target = -1;
+    for (size_t i = 0; i < aliens.size(); i++) {
+        if (aliens.alive[i] && (target < 0 || aliens.y[i] > aliens.y[target])) {
+            target = static_cast<long>(i);
+        }
+    }
+    if (target >= 0) {
+        float playerCenter = game.playerX + game.config.playerWidth / 2;
+        float alienCenter = aliens.x[target] + aliens.w[target] / 2;
+        input.left = alienCenter < playerCenter - 8;
+        input.right = alienCenter > playerCenter + 8;
+    }
+    return input;
+}
+
+//False for anything but the three lower-case names, so a typo never runs EASY by mistake
+static bool parseLevel(const char* name, Level& level) {
+    if (strcmp(name, "easy") == 0) level = Level::EASY;
+    else if (strcmp(name, "medium") == 0) level = Level::MEDIUM;
+    else if (strcmp(name, "hard") == 0) level = Level::HARD;
+    else {
+        cerr << "Unknown level: " << name << " (expected easy, medium or hard)" << endl;
+        return false;
+    }
+    return true;
+}
+
+static int runReplay(const string& path) {
+    Replay replay;
+    if (!loadReplay(path, replay)) {
+        cerr << "Error: Could not load replay " << path << endl;
+        return 1;
+    }
+    auto start = chrono::steady_clock::now();
+    unsigned long long checksum = 0;
+    bool ok = verifyReplay(replay, &checksum);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "ticks: " << replay.inputs.size() << endl;
+    cout << "seconds: " << seconds << endl;
+    cout << "checksum: " << hex << checksum << " expected " << replay.checksum << dec << endl;
+    cout << (ok ? "replay OK" : "replay MISMATCH") << endl;
+    return ok ? 0 : 2;
+}
+
+static const char* levelName(Level level) {
+    switch (level) {
+    case Level::MEDIUM:
+        return "medium";
+    case Level::HARD:
+        return "hard";
+    default:
+        return "easy";
+    }
+}
+
+//"a,b,c" -> each item; false if any item is empty
+static bool splitList(const string& text, vector<string>& items) {
+    items.clear();
+    stringstream stream(text);
+    string item;
+    while (getline(stream, item, ',')) {
+        if (item.empty()) {
+            return false;
+        }
+        items.push_back(item);
+    }
+    return !items.empty();
+}
+
+struct BatchOptions {
+    unsigned long long games = 0;      // per parameter set
+    unsigned long long seed = 1;
+    unsigned long long maxTicks = 10 * 60 * TICK_RATE;
+    unsigned threads = 0;              // 0 = every core
+    vector<Level> levels;
+    vector<float> speeds;              // empty = each level's own speed
+    vector<float> spawnIntervals;      // seconds; empty = ALIEN_SPAWN_INTERVAL
+    const SpawnTimeline* waves = nullptr;
+    const char* csvPath = nullptr;
+};
+
+//One level / speed / spawn interval combination
+struct BatchSet {
+    Level level = Level::EASY;
+    float alienSpeed = 0;
+    float spawnInterval = 0;
+    SpawnTimeline timeline;
+};
+
+struct BatchGame {
+    int score = 0;
+    unsigned long long ticks = 0;
+    bool timedOut = false;
+};
+
+//Value at fraction q of a sorted list
+template <class T>
+static T percentile(const vector<T>& sorted, double q) {
+    if (sorted.empty()) {
+        return T();
+    }
+    size_t index = min(sorted.size() - 1, static_cast<size_t>(q * (sorted.size() - 1) + 0.5));
+    return sorted[index];
+}
+
+static void printBatchSet(const BatchSet& set, const BatchGame* games, size_t count) {
+    vector<int> scores;
+    vector<double> survival;
+    scores.reserve(count);
+    survival.reserve(count);
+    double scoreSum = 0, survivalSum = 0;
+    size_t timedOut = 0;
+    for (size_t i = 0; i < count; i++) {
+        scores.push_back(games[i].score);
+        survival.push_back(static_cast<double>(games[i].ticks) / TICK_RATE);
+        scoreSum += games[i].score;
+        survivalSum += survival.back();
+        timedOut += games[i].timedOut ? 1 : 0;
+    }
+    sort(scores.begin(), scores.end());
+    sort(survival.begin(), survival.end());
+
+    cout << levelName(set.level) << ", speed " << set.alienSpeed << " px/s, ";
+    if (set.spawnInterval > 0) {
+        cout << "alien every " << set.spawnInterval << " s";
+    }
+    else {
+        cout << "wave script";
+    }
+    cout << " (" << count << " games, " << timedOut << " hit the tick limit)" << endl;
+    cout << "  survival s: mean " << survivalSum / count << ", p10 " << percentile(survival, 0.1) << ", median "
+         << percentile(survival, 0.5) << ", p90 " << percentile(survival, 0.9) << ", max " << survival.back() << endl;
+    cout << "  score:      mean " << scoreSum / count << ", p10 " << percentile(scores, 0.1) << ", median "
+         << percentile(scores, 0.5) << ", p90 " << percentile(scores, 0.9) << ", max " << scores.back() << endl;
+
+    //Ten equal-width buckets from 0 to the best score
+    const int BUCKETS = 10;
+    int width = max(1, (scores.back() + BUCKETS) / BUCKETS);
+    size_t counts[BUCKETS] = {};
+    for (int score : scores) {
+        counts[min(BUCKETS - 1, score / width)]++;
+    }
+    cout << "  scores:";
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        cout << " " << bucket * width << "+:" << counts[bucket];
+    }
+    cout << endl;
+}
+
+static int runBatch(const BatchOptions& options) {
+    //Every parameter set, each with the timeline its games spawn from
+    vector<BatchSet> sets;
+    vector<float> intervals = options.spawnIntervals;
+    if (options.waves || intervals.empty()) {
+        intervals.assign(1, options.waves ? 0.0f : ALIEN_SPAWN_INTERVAL);
+    }
+    for (Level level : options.levels) {
+        vector<float> speeds = options.speeds;
+        if (speeds.empty()) {
+            speeds.push_back(levelAlienSpeed(level));
+        }
+        for (float speed : speeds) {
+            for (float interval : intervals) {
+                BatchSet set;
+                set.level = level;
+                set.alienSpeed = speed;
+                set.spawnInterval = interval;
+                if (!options.waves) {
+                    unsigned alienTicks = static_cast<unsigned>(max(1.0f, interval * TICK_RATE + 0.5f));
+                    set.timeline = clockTimeline(alienTicks, HEART_SPAWN_TICKS);
+                }
+                sets.push_back(set);
+            }
+        }
+    }
+
+    //Whole games are the unit of work, so stealing evens out short and long games
+    JobSystem jobs(options.threads > 0 ? options.threads - 1 : 0);
+    vector<BatchGame> results(sets.size() * options.games);
+    auto playGames = [&](size_t begin, size_t end) {
+        Game game;
+        for (size_t i = begin; i < end; i++) {
+            const BatchSet& set = sets[i / options.games];
+            GameConfig config = defaultConfig(set.level);
+            config.alienSpeed = set.alienSpeed;
+            game.timeline = options.waves ? options.waves : &set.timeline;
+            resetGame(game, config, options.seed + i % options.games);
+            while (!game.over && game.tick < options.maxTicks) {
+                step(game, TICK_DT, botInput(game));
+            }
+            results[i].score = game.score;
+            results[i].ticks = game.tick;
+            results[i].timedOut = !game.over;
+        }
+    };
+    auto start = chrono::steady_clock::now();
+    jobs.parallelFor("batch", results.size(), 1, playGames);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    unsigned long long totalTicks = 0;
+    for (const BatchGame& result : results) {
+        totalTicks += result.ticks;
+    }
+    cout << "games: " << results.size() << " on " << jobs.threadCount() << " threads" << endl;
+    cout << "seconds: " << seconds << endl;
+    cout << "ticks/s: " << (seconds > 0 ? totalTicks / seconds : 0) << endl;
+    for (size_t i = 0; i < sets.size(); i++) {
+        printBatchSet(sets[i], &results[i * options.games], static_cast<size_t>(options.games));
+    }
+
+    if (options.csvPath) {
+        ofstream out(options.csvPath);
+        if (!out.is_open()) {
+            cerr << "Error: Could not write " << options.csvPath << endl;
+            return 1;
+        }
+        out << "level,alien_speed,spawn_interval,seed,score,ticks,timed_out\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const BatchSet& set = sets[i / options.games];
+            out << levelName(set.level) << "," << set.alienSpeed << "," << set.spawnInterval << "," << options.seed + i % options.games
+                << "," << results[i].score << "," << results[i].ticks << "," << (results[i].timedOut ? 1 : 0) << "\n";
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned long long ticks = 1000000;
+    unsigned long long seed = 1;
+    Level level = Level::EASY;
+    const char* profilePath = nullptr;
+    const char* recordPath = nullptr;
+    const char* wavesPath = nullptr;
+    const char* statePath = nullptr;
+    const char* saveStatePath = nullptr;
+    BatchOptions batch;
+    vector<string> items;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool listOk = hasValue && splitList(argv[i + 1], items);
+        if (arg == "--ticks" && hasValue) ticks = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--batch" && hasValue) batch.games = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--max-ticks" && hasValue) batch.maxTicks = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && hasValue) batch.threads = static_cast<unsigned>(atoi(argv[++i]));
+        else if (arg == "--csv" && hasValue) batch.csvPath = argv[++i];
+        else if (arg == "--levels" && listOk) {
+            i++;
+            for (const string& item : items) {
+                Level parsed;
+                if (!parseLevel(item.c_str(), parsed)) return 1;
+                batch.levels.push_back(parsed);
+            }
+        }
+        else if ((arg == "--speeds" || arg == "--spawn-intervals") && listOk) {
+            i++;
+            vector<float>& values = arg == "--speeds" ? batch.speeds : batch.spawnIntervals;
+            for (const string& item : items) values.push_back(max(0.01f, static_cast<float>(atof(item.c_str()))));
+        }
+        else if (arg == "--level" && hasValue) {
+            if (!parseLevel(argv[++i], level)) return 1;
+        }
+        else if (arg == "--seed" && hasValue) seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--profile" && hasValue) profilePath = argv[++i];
+        else if (arg == "--record" && hasValue) recordPath = argv[++i];
+        else if (arg == "--waves" && hasValue) wavesPath = argv[++i];
+        else if (arg == "--state" && hasValue) statePath = argv[++i];
+        else if (arg == "--save-state" && hasValue) saveStatePath = argv[++i];
+        else if (arg == "--replay" && hasValue) return runReplay(argv[++i]);
+        else {
+            cerr << "Unknown argument: " << arg << endl;
+            return 1;
+        }
+    }
+
+    SpawnTimeline timeline;
+    if (wavesPath && !loadTimeline(wavesPath, timeline)) {
+        return 1;
+    }
+    if (batch.games > 0) {
+        batch.seed = seed;
+        batch.waves = wavesPath ? &timeline : nullptr;
+        if (batch.levels.empty()) {
+            batch.levels.push_back(level);
+        }
+        return runBatch(batch);
+    }
+
+    //Every tick counts as one profiler frame
+    Profiler profiler(1 << 16);
+    Game game;
+    if (wavesPath) {
+        game.timeline = &timeline;
+    }
+    resetGame(game, defaultConfig(level), seed);
+    if (statePath) {
+        SaveState state;
+        if (!loadStateFile(statePath, state) || !state.restore(game)) {
+            cerr << "Error: Could not load state " << statePath << endl;
+            return 1;
+        }
+        cout << "state: tick " << game.tick << ", " << game.aliens.size() << " aliens, " << game.bullets.size() << " bullets, "
+             << game.bonusHearts.size() << " hearts" << endl;
+    }
+    if (profilePath) {
+        game.profiler = &profiler;
+    }
+
+    //Recording covers the first game only, and only from tick 0
+    if (recordPath && game.tick != 0) {
+        cerr << "Error: --record needs a game that starts at tick 0" << endl;
+        return 1;
+    }
+    Replay replay;
+    bool recording = recordPath != nullptr;
+    replay.begin(game);
+
+    unsigned long long games = 1;
+    long long totalScore = 0;
+    //Process-wide: a tick's allocations include any made by job workers during step()
+    AllocFrameMonitor allocMonitor("tick", 120, ALLOC_PROCESS);
+    auto start = chrono::steady_clock::now();
+    for (unsigned long long i = 0; i < ticks; i++) {
+        GameInput input = botInput(game);
+        if (recording) replay.record(input);
+        if (profilePath) profiler.beginFrame();
+        allocMonitor.beginFrame();
+        step(game, TICK_DT, input);
+        allocMonitor.endFrame();
+        if (profilePath) profiler.endFrame();
+        if (game.over) {
+            if (recording) {
+                replay.finish(game);
+                recording = false;
+            }
+            totalScore += game.score;
+            resetGame(game, game.config, seed + games);
+            games++;
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "ticks: " << ticks << endl;
+    cout << "games: " << games << endl;
+    cout << "total score: " << totalScore + game.score << endl;
+    cout << "seconds: " << seconds << endl;
+    cout << "ticks/s: " << (seconds > 0 ? ticks / seconds : 0) << endl;
+    if (allocCountingEnabled()) {
+        cout << "ticks allocating after warm-up: " << allocMonitor.flaggedFrames() << endl;
+        cout << "arena high water: " << game.arena.highWater() << " bytes" << endl;
+    }
+    if (profilePath) {
+        for (int phase = PHASE_INPUT; phase <= PHASE_COLLIDE_HEARTS; phase++) {
+            PhaseStats stats = profiler.stats(static_cast<ProfilePhase>(phase), 1 << 16);
+            cout << "  " << phaseName(static_cast<ProfilePhase>(phase)) << ": avg " << stats.average << " us, p99 " << stats.p99 << " us" << endl;
+        }
+        if (!profiler.writeCsv(profilePath)) {
+            cerr << "Error: Could not write " << profilePath << endl;
+        }
+    }
+    if (recordPath) {
+        //A game still running at the tick limit is recorded as far as it got
+        if (recording) {
+            replay.finish(game);
+        }
+        if (!saveReplay(recordPath, replay)) {
+            cerr << "Error: Could not write " << recordPath << endl;
+            return 1;
+        }
+        cout << "recorded " << replay.inputs.size() << " ticks, checksum " << hex << replay.checksum << dec << endl;
+    }
+    if (saveStatePath) {
+        SaveState state;
+        state.capture(game);
+        if (!saveStateFile(saveStatePath, state)) {
+            return 1;
+        }
+        cout << "saved state at tick " << game.tick << " (" << state.size() << " bytes)" << endl;
+    }
+    return 0;
+}
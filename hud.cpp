@@ -0,0 +1,158 @@
+#include "hud.h"
+#include <cstdio>
+#include <string>
+#include "game.h"
+
+using namespace sf;
+using namespace std;
+
+Hud::Hud(const Font& font, bool cacheLayer) {
+    scoreText.setFont(font);
+    scoreText.setCharacterSize(60);
+    scoreText.setFillColor(Color::White);
+    scoreText.setPosition(800, 10);
+
+    highScoreText.setFont(font);
+    highScoreText.setCharacterSize(60);
+    highScoreText.setFillColor(Color::White);
+    highScoreText.setPosition(1300, 10);
+
+    //Fall back to drawing the texts directly if render textures are unavailable
+    if (cacheLayer && layer.create(WINDOW_WIDTH, static_cast<unsigned>(HUD_HEIGHT))) {
+        useLayer = true;
+        layerSprite.setTexture(layer.getTexture());
+    }
+}
+
+void Hud::setScore(int value) {
+    if (value == score) {
+        return;
+    }
+    score = value;
+    scoreText.setString("Score: " + to_string(score));
+    layerDirty = true;
+    rebuilds++;
+    rebuildsThisSecond++;
+}
+
+void Hud::setHighScore(int value) {
+    if (value == highScore) {
+        return;
+    }
+    highScore = value;
+    highScoreText.setString("Highest Score: " + to_string(highScore));
+    layerDirty = true;
+    rebuilds++;
+    rebuildsThisSecond++;
+}
+
+void Hud::rebuildLayer() {
+    layer.clear(Color::Transparent);
+    layer.draw(scoreText);
+    layer.draw(highScoreText);
+    layer.display();
+    layerDirty = false;
+}
+
+void Hud::tickRate() {
+    if (rateClock.getElapsedTime().asSeconds() >= 1.0f) {
+        lastRebuildRate = rebuildsThisSecond;
+        rebuildsThisSecond = 0;
+        rateClock.restart();
+    }
+}
+
+void Hud::draw(RenderTarget& target, RenderStats& stats) {
+    tickRate();
+    if (useLayer) {
+        if (layerDirty) {
+            rebuildLayer();
+        }
+        drawCounted(target, layerSprite, stats);
+    }
+    else {
+        drawCounted(target, scoreText, stats);
+        drawCounted(target, highScoreText, stats);
+    }
+}
+
+//Frames averaged over, and how often the text is rebuilt
+const size_t OVERLAY_WINDOW = 240;
+const int OVERLAY_REFRESH_FRAMES = 15;
+
+ProfilerOverlay::ProfilerOverlay(const Font& font, const Profiler& profiler) : profiler(profiler) {
+    text.setFont(font);
+    text.setCharacterSize(22);
+    text.setFillColor(Color::Green);
+    text.setPosition(20, 130);
+
+    panel.setPosition(10, 120);
+    panel.setSize(Vector2f(520, 30.0f * (PHASE_COUNT + 2)));
+    panel.setFillColor(Color(0, 0, 0, 170));
+}
+
+void ProfilerOverlay::refresh() {
+    string lines = "phase            avg us    p99 us\n";
+    char line[96];
+    double total = 0;
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        bool simPhase = phase >= PHASE_INPUT && phase <= PHASE_COLLIDE_HEARTS;
+        const Profiler& source = sim && simPhase ? *sim : profiler;
+        PhaseStats phaseStats = source.stats(static_cast<ProfilePhase>(phase), OVERLAY_WINDOW);
+        snprintf(line, sizeof(line), "%-15s %8.1f  %8.1f\n", phaseName(static_cast<ProfilePhase>(phase)), phaseStats.average, phaseStats.p99);
+        lines += line;
+        total += phaseStats.average;
+    }
+    snprintf(line, sizeof(line), "%-15s %8.1f", "total", total);
+    lines += line;
+    int lineCount = PHASE_COUNT + 2;
+    if (jobTimings) {
+        for (const auto& timing : *jobTimings) {
+            snprintf(line, sizeof(line), "\njob %-11s %8.1f  %u chunks %u stolen", timing.name, timing.micros, timing.chunks, timing.steals);
+            lines += line;
+            lineCount++;
+        }
+    }
+    panel.setSize(Vector2f(520, 30.0f * lineCount));
+    text.setString(lines);
+}
+
+void ProfilerOverlay::draw(RenderTarget& target, RenderStats& stats) {
+    if (!visible) {
+        return;
+    }
+    if (--framesUntilRefresh <= 0) {
+        refresh();
+        framesUntilRefresh = OVERLAY_REFRESH_FRAMES;
+    }
+    drawCounted(target, panel, stats);
+    drawCounted(target, text, stats);
+}
+
+void MenuBackdrop::compose(const Drawable& background, initializer_list<const Drawable*> statics) {
+    drawables.assign(1, &background);
+    drawables.insert(drawables.end(), statics.begin(), statics.end());
+    //Fall back to drawing the pieces every time if render textures are unavailable
+    if (!layer.create(WINDOW_WIDTH, WINDOW_HEIGHT)) {
+        useLayer = false;
+        return;
+    }
+    layer.clear();
+    for (const Drawable* drawable : drawables) {
+        layer.draw(*drawable);
+    }
+    layer.display();
+    layerSprite.setTexture(layer.getTexture(), true);
+    drawables.clear();
+    useLayer = true;
+}
+
+void MenuBackdrop::draw(RenderTarget& target) const {
+    if (useLayer) {
+        target.draw(layerSprite);
+        return;
+    }
+    for (const Drawable* drawable : drawables) {
+        target.draw(*drawable);
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <initializer_list>
+#include <vector>
+#include "jobs.h"
+#include "profiler.h"
+#include "render.h"
+
+// Score and high-score display. The text objects live as long as the HUD and
+// their glyphs are only laid out again when a value actually changes. With
+// the cached layer on, both texts are rendered into a render texture on
+// change and the frame just draws that texture.
+
+const float HUD_HEIGHT = 100.0f;
+
+class Hud {
+public:
+    explicit Hud(const sf::Font& font, bool cacheLayer = true);
+
+    void setScore(int score);
+    void setHighScore(int highScore);
+    void draw(sf::RenderTarget& target, RenderStats& stats);
+
+    //Text re-layouts counted over the last full second
+    int rebuildsPerSecond() const { return lastRebuildRate; }
+    long long totalRebuilds() const { return rebuilds; }
+
+private:
+    void rebuildLayer();
+    void tickRate();
+
+    sf::Text scoreText;
+    sf::Text highScoreText;
+    int score = -1;
+    int highScore = -1;
+
+    bool useLayer = false;
+    bool layerDirty = true;
+    sf::RenderTexture layer;
+    sf::Sprite layerSprite;
+
+    long long rebuilds = 0;
+    int rebuildsThisSecond = 0;
+    int lastRebuildRate = 0;
+    sf::Clock rateClock;
+};
+
+// Toggleable text overlay with per-phase average and p99 frame timings.
+// The text is refreshed a few times per second, not every frame.
+
+class ProfilerOverlay {
+public:
+    ProfilerOverlay(const sf::Font& font, const Profiler& profiler);
+
+    void toggle() { visible = !visible; }
+    //Simulation phases come from this profiler when the simulation runs on its own thread
+    void setSimProfiler(const Profiler* simProfiler) { sim = simProfiler; }
+    //Also list these job timings; the vector must stay valid while the overlay is drawn
+    void setJobTimings(const std::vector<JobTiming>* timings) { jobTimings = timings; }
+    bool isVisible() const { return visible; }
+    void draw(sf::RenderTarget& target, RenderStats& stats);
+
+private:
+    void refresh();
+
+    const Profiler& profiler;
+    const Profiler* sim = nullptr;
+    const std::vector<JobTiming>* jobTimings = nullptr;
+    sf::RectangleShape panel;
+    sf::Text text;
+    bool visible = false;
+    int framesUntilRefresh = 0;
+};
+
+// Static part of a menu screen: the scaled background and any text that
+// never changes, composed once into a render texture. Menus draw it and then
+// their live items on top, and only when something changed.
+
+class MenuBackdrop {
+public:
+    //The drawables are rendered once here and not referenced afterwards,
+    //unless render textures are unavailable
+    void compose(const sf::Drawable& background, std::initializer_list<const sf::Drawable*> statics = {});
+    void draw(sf::RenderTarget& target) const;
+
+private:
+    bool useLayer = false;
+    sf::RenderTexture layer;
+    sf::Sprite layerSprite;
+    std::vector<const sf::Drawable*> drawables;
+};
@@ -0,0 +1,113 @@
+#include "input.h"
+#include <algorithm>
+#include "replay.h"
+
+using namespace std;
+
+const char* actionName(InputAction action) {
+    switch (action) {
+    case ACTION_LEFT: return "left";
+    case ACTION_RIGHT: return "right";
+    case ACTION_UP: return "up";
+    case ACTION_DOWN: return "down";
+    case ACTION_FIRE: return "fire";
+    case ACTION_CONFIRM: return "confirm";
+    case ACTION_BACK: return "back";
+    case ACTION_QUIT: return "quit";
+    case ACTION_PROFILER: return "profiler";
+    case ACTION_OTHER: return "other";
+    default: return "unknown";
+    }
+}
+
+unsigned char actionInputBit(InputAction action) {
+    //Same layout as packInput()
+    switch (action) {
+    case ACTION_LEFT: return 1;
+    case ACTION_RIGHT: return 2;
+    case ACTION_UP: return 4;
+    case ACTION_DOWN: return 8;
+    case ACTION_FIRE: return 16;
+    default: return 0;
+    }
+}
+
+bool InputQueue::push(const InputEvent& event) {
+    size_t t = tail.load(memory_order_relaxed);
+    if (t - head.load(memory_order_acquire) >= SIZE) {
+        droppedCount.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    events[t % SIZE] = event;
+    tail.store(t + 1, memory_order_release);
+    return true;
+}
+
+bool InputQueue::popUntil(chrono::steady_clock::time_point time, InputEvent& event) {
+    size_t h = head.load(memory_order_relaxed);
+    if (h == tail.load(memory_order_acquire) || events[h % SIZE].time > time) {
+        return false;
+    }
+    event = events[h % SIZE];
+    head.store(h + 1, memory_order_release);
+    return true;
+}
+
+void InputQueue::clear() {
+    head.store(tail.load(memory_order_acquire), memory_order_release);
+}
+
+void TickInput::apply(const InputEvent& event) {
+    unsigned char bit = actionInputBit(event.action);
+    if (event.pressed) {
+        held |= bit;
+        latched |= bit;
+    }
+    else {
+        held &= static_cast<unsigned char>(~bit);
+    }
+}
+
+GameInput TickInput::take() {
+    GameInput input = unpackInput(held | latched);
+    latched = 0;
+    return input;
+}
+
+void TickInput::reset() {
+    held = 0;
+    latched = 0;
+}
+
+InputLatency::InputLatency(size_t capacity) : capacity(max<size_t>(capacity, 1)) {
+}
+
+void InputLatency::record(InputAction action, chrono::steady_clock::time_point event, chrono::steady_clock::time_point presented) {
+    float millis = chrono::duration<float, milli>(presented - event).count();
+    Samples& s = samples[action];
+    if (s.ring.size() < capacity) {
+        s.ring.push_back(millis);
+    }
+    else {
+        s.ring[s.count % capacity] = millis;
+    }
+    s.count++;
+    s.sum += millis;
+    s.max = max(s.max, millis);
+}
+
+void InputLatency::printReport(ostream& out) const {
+    out << "Input to present latency:" << endl;
+    vector<float> sorted;
+    for (int action = 0; action < ACTION_COUNT; action++) {
+        const Samples& s = samples[action];
+        if (s.count == 0) {
+            continue;
+        }
+        sorted = s.ring;
+        sort(sorted.begin(), sorted.end());
+        float p99 = sorted[min(sorted.size() - 1, static_cast<size_t>(sorted.size() * 0.99))];
+        out << "  " << actionName(static_cast<InputAction>(action)) << ": " << s.count << " presses, " << s.sum / s.count
+            << " ms avg, " << p99 << " ms p99, " << s.max << " ms max" << endl;
+    }
+}
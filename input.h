@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <vector>
+#include "game.h"
+
+// Event-driven input, independent of SFML. Key events are stamped when the
+// window thread drains them and mapped to actions. Gameplay actions go
+// through an InputQueue to the simulation, which applies them per tick in
+// timestamp order. Presses are latched until the next tick, so a tap that
+// is released before the tick still fires for one tick.
+
+enum InputAction {
+    ACTION_LEFT,
+    ACTION_RIGHT,
+    ACTION_UP,
+    ACTION_DOWN,
+    ACTION_FIRE,
+    ACTION_CONFIRM,
+    ACTION_BACK,
+    ACTION_QUIT,
+    ACTION_PROFILER,
+    //Any key without a binding, for "press any key" screens
+    ACTION_OTHER,
+    ACTION_COUNT
+};
+
+const char* actionName(InputAction action);
+//Bit of the action in a packed GameInput; 0 for actions the simulation ignores
+unsigned char actionInputBit(InputAction action);
+
+struct InputEvent {
+    InputAction action = ACTION_OTHER;
+    bool pressed = false;
+    //A press the OS repeated while the key was held
+    bool repeat = false;
+    std::chrono::steady_clock::time_point time;
+};
+
+// Bounded single-producer, single-consumer ring from the window thread to
+// the simulation thread. A full queue drops the event and counts it.
+
+class InputQueue {
+public:
+    bool push(const InputEvent& event);
+    //Pops the oldest event if it happened no later than time
+    bool popUntil(std::chrono::steady_clock::time_point time, InputEvent& event);
+    void clear();
+    unsigned long long dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    static const size_t SIZE = 256;
+    InputEvent events[SIZE];
+    std::atomic<size_t> head{ 0 };
+    std::atomic<size_t> tail{ 0 };
+    std::atomic<unsigned long long> droppedCount{ 0 };
+};
+
+//Held and latched game keys, built up from events between ticks
+class TickInput {
+public:
+    void apply(const InputEvent& event);
+    //Keys for the next tick; clears the latched presses
+    GameInput take();
+    void reset();
+
+private:
+    unsigned char held = 0;
+    unsigned char latched = 0;
+};
+
+// Time from a key event to the end of the frame that first shows its
+// effect, per action. The newest samples are kept in a ring for the
+// percentiles; count, mean and max cover everything.
+
+class InputLatency {
+public:
+    explicit InputLatency(size_t capacity = 1024);
+
+    void record(InputAction action, std::chrono::steady_clock::time_point event, std::chrono::steady_clock::time_point presented);
+    void printReport(std::ostream& out) const;
+
+private:
+    struct Samples {
+        std::vector<float> ring;
+        unsigned long long count = 0;
+        double sum = 0;
+        float max = 0;
+    };
+
+    size_t capacity;
+    Samples samples[ACTION_COUNT];
+};
@@ -0,0 +1,129 @@
+#include "jobs.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+
+JobSystem::JobSystem(unsigned workers) {
+    if (workers == 0) {
+        unsigned hardware = thread::hardware_concurrency();
+        workers = hardware > 1 ? hardware - 1 : 0;
+    }
+    //Queue 0 belongs to the thread that calls parallelFor
+    for (unsigned i = 0; i <= workers; i++) {
+        queues.emplace_back(new Queue());
+    }
+    for (unsigned i = 1; i <= workers; i++) {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+    timings.reserve(64);
+}
+
+JobSystem::~JobSystem() {
+    {
+        lock_guard<mutex> guard(wakeLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : threads) {
+        worker.join();
+    }
+}
+
+bool JobSystem::pop(unsigned index, Chunk& chunk) {
+    Queue& queue = *queues[index];
+    lock_guard<mutex> guard(queue.lock);
+    if (queue.first == queue.last) {
+        return false;
+    }
+    chunk = queue.chunks[--queue.last];
+    return true;
+}
+
+bool JobSystem::steal(unsigned index, Chunk& chunk) {
+    for (unsigned offset = 1; offset < queues.size(); offset++) {
+        Queue& victim = *queues[(index + offset) % queues.size()];
+        lock_guard<mutex> guard(victim.lock);
+        if (victim.first != victim.last) {
+            chunk = victim.chunks[victim.first++];
+            steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::drain(unsigned index) {
+    while (remaining.load(memory_order_acquire) > 0) {
+        Chunk chunk;
+        if (pop(index, chunk) || steal(index, chunk)) {
+            chunkFn(context, chunk.begin, chunk.end);
+            remaining.fetch_sub(1, memory_order_acq_rel);
+        }
+        else {
+            this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::workerLoop(unsigned index) {
+    unsigned long long seen = 0;
+    while (true) {
+        {
+            unique_lock<mutex> guard(wakeLock);
+            wake.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+        drain(index);
+    }
+}
+
+void JobSystem::run(const char* name, size_t count, size_t grain, void* newContext, ChunkFn fn) {
+    auto start = chrono::steady_clock::now();
+    JobTiming timing;
+    timing.name = name;
+    if (count == 0) {
+        timings.push_back(timing);
+        return;
+    }
+    grain = max<size_t>(grain, 1);
+    size_t chunks = (count + grain - 1) / grain;
+    unsigned stealsBefore = steals.load();
+
+    if (queues.size() == 1 || chunks == 1) {
+        fn(newContext, 0, count);
+    }
+    else {
+        context = newContext;
+        chunkFn = fn;
+        //Every queue was drained by the previous run, so each starts from zero
+        size_t perQueue = (chunks + queues.size() - 1) / queues.size();
+        for (size_t q = 0; q < queues.size(); q++) {
+            Queue& queue = *queues[q];
+            lock_guard<mutex> guard(queue.lock);
+            if (queue.chunks.size() < perQueue) {
+                queue.chunks.resize(perQueue);
+            }
+            queue.first = 0;
+            queue.last = 0;
+            for (size_t i = q; i < chunks; i += queues.size()) {
+                queue.chunks[queue.last++] = { i * grain, min(count, (i + 1) * grain) };
+            }
+        }
+        remaining.store(chunks, memory_order_release);
+        {
+            lock_guard<mutex> guard(wakeLock);
+            generation++;
+        }
+        wake.notify_all();
+        drain(0);
+    }
+
+    timing.chunks = static_cast<unsigned>(chunks);
+    timing.steals = steals.load() - stealsBefore;
+    timing.micros = chrono::duration<float, micro>(chrono::steady_clock::now() - start).count();
+    timings.push_back(timing);
+}
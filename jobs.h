@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small worker pool for splitting per-entity loops across cores.
+// parallelFor() cuts a range into chunks, deals them round-robin onto
+// per-thread deques and blocks until every chunk has run. The calling
+// thread works too. A thread pops from the back of its own deque and
+// steals from the front of the others when it runs dry. Each deque has
+// its own short mutex; there is no global lock. The deques are flat arrays
+// that keep their storage, so a steady workload allocates nothing.
+//
+// Callers keep results deterministic by writing each chunk's output to
+// its own slots and merging afterwards in index order.
+
+struct JobTiming {
+    const char* name = "";
+    float micros = 0;
+    unsigned chunks = 0;
+    unsigned steals = 0;
+};
+
+class JobSystem {
+public:
+    //0 workers means one per extra hardware thread
+    explicit JobSystem(unsigned workers = 0);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned threadCount() const { return static_cast<unsigned>(queues.size()); }
+
+    template <class Fn>
+    void parallelFor(const char* name, size_t count, size_t grain, Fn& fn) {
+        run(name, count, grain, &fn, [](void* context, size_t begin, size_t end) { (*static_cast<Fn*>(context))(begin, end); });
+    }
+
+    //Timings of every parallelFor since the last beginTick()
+    void beginTick() { timings.clear(); }
+    const std::vector<JobTiming>& tickTimings() const { return timings; }
+
+private:
+    typedef void (*ChunkFn)(void* context, size_t begin, size_t end);
+
+    struct Chunk {
+        size_t begin, end;
+    };
+
+    //Chunks [first, last) are pending; the owner takes from last, thieves from first
+    struct Queue {
+        std::mutex lock;
+        std::vector<Chunk> chunks;
+        size_t first = 0, last = 0;
+    };
+
+    void run(const char* name, size_t count, size_t grain, void* context, ChunkFn fn);
+    void workerLoop(unsigned index);
+    void drain(unsigned index);
+    bool pop(unsigned index, Chunk& chunk);
+    bool steal(unsigned index, Chunk& chunk);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    void* context = nullptr;
+    ChunkFn chunkFn = nullptr;
+    std::atomic<size_t> remaining{ 0 };
+    std::atomic<unsigned> steals{ 0 };
+
+    std::mutex wakeLock;
+    std::condition_variable wake;
+    unsigned long long generation = 0;
+    bool stopping = false;
+
+    std::vector<JobTiming> timings;
+};
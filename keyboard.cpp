@@ -0,0 +1,114 @@
+#include "keyboard.h"
+#include <algorithm>
+
+using namespace sf;
+using namespace std;
+
+//Sleep between polls while waiting with a timeout
+static const Time WAIT_SLICE = milliseconds(2);
+
+InputAction keyAction(Keyboard::Key key) {
+    switch (key) {
+    case Keyboard::Left: return ACTION_LEFT;
+    case Keyboard::Right: return ACTION_RIGHT;
+    case Keyboard::Up: return ACTION_UP;
+    case Keyboard::Down: return ACTION_DOWN;
+    case Keyboard::Space: return ACTION_FIRE;
+    case Keyboard::Enter: return ACTION_CONFIRM;
+    case Keyboard::BackSpace: return ACTION_BACK;
+    case Keyboard::Escape: return ACTION_QUIT;
+    case Keyboard::F3: return ACTION_PROFILER;
+    default: return ACTION_OTHER;
+    }
+}
+
+void InputSystem::add(InputAction action, bool pressed, chrono::steady_clock::time_point time) {
+    InputEvent event;
+    event.action = action;
+    event.pressed = pressed;
+    event.repeat = pressed && down[action];
+    event.time = time;
+    if (!pressed && down[action]) {
+        //Released in the same batch it was pressed in
+        for (const InputEvent& earlier : frameEvents) {
+            if (earlier.action == action && earlier.pressed && !earlier.repeat) {
+                taps++;
+                break;
+            }
+        }
+    }
+    //Unbound keys are never held, so every press of one counts
+    down[action] = pressed && action != ACTION_OTHER;
+    frameEvents.push_back(event);
+}
+
+void InputSystem::handle(RenderWindow& window, const Event& event) {
+    auto now = chrono::steady_clock::now();
+    if (event.type == Event::Closed) {
+        window.close();
+    }
+    else if (event.type == Event::KeyPressed) {
+        add(keyAction(event.key.code), true, now);
+    }
+    else if (event.type == Event::KeyReleased) {
+        add(keyAction(event.key.code), false, now);
+    }
+    else if (event.type == Event::LostFocus) {
+        for (int action = 0; action < ACTION_COUNT; action++) {
+            if (down[action]) {
+                add(static_cast<InputAction>(action), false, now);
+            }
+        }
+    }
+    else if (event.type == Event::GainedFocus || event.type == Event::Resized) {
+        windowExposed = true;
+    }
+}
+
+void InputSystem::poll(RenderWindow& window) {
+    frameEvents.clear();
+    windowExposed = false;
+    Event event;
+    while (window.pollEvent(event)) {
+        handle(window, event);
+    }
+}
+
+void InputSystem::wait(RenderWindow& window, Time timeout) {
+    frameEvents.clear();
+    windowExposed = false;
+    Event event;
+    if (timeout == Time::Zero) {
+        if (!window.waitEvent(event)) {
+            return;
+        }
+    }
+    else {
+        //SFML 2 has no timed waitEvent, so poll in short sleeps until the deadline
+        Clock clock;
+        while (!window.pollEvent(event)) {
+            Time left = timeout - clock.getElapsedTime();
+            if (left <= Time::Zero || !window.isOpen()) {
+                return;
+            }
+            sf::sleep(min(left, WAIT_SLICE));
+        }
+    }
+    handle(window, event);
+    while (window.pollEvent(event)) {
+        handle(window, event);
+    }
+}
+
+void InputSystem::presented() {
+    auto now = chrono::steady_clock::now();
+    for (const InputEvent& event : frameEvents) {
+        if (event.pressed && !event.repeat) {
+            latencyStats.record(event.action, event.time, now);
+        }
+    }
+}
+
+void InputSystem::presented(InputAction action, chrono::steady_clock::time_point event) {
+    latencyStats.record(action, event, chrono::steady_clock::now());
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "input.h"
+
+// The window side of the input pipeline. poll() drains every pending window
+// event once per frame, stamps each key event and maps it to an action.
+// Menus walk events(); the game loop forwards them to the simulation. Both
+// report presented() after display() so input-to-present latency is known.
+// Idle menus use wait() instead, which sleeps until something arrives.
+
+InputAction keyAction(sf::Keyboard::Key key);
+
+class InputSystem {
+public:
+    //Closes the window on a close request; releases every key when focus is lost
+    void poll(sf::RenderWindow& window);
+    //Like poll(), but blocks until at least one event arrives or the timeout
+    //passes; a zero timeout waits indefinitely
+    void wait(sf::RenderWindow& window, sf::Time timeout = sf::Time::Zero);
+    //True if the last poll saw the window regain focus or change size, so its contents must be redrawn
+    bool exposed() const { return windowExposed; }
+    //Key events of the last poll, oldest first
+    const std::vector<InputEvent>& events() const { return frameEvents; }
+    bool isHeld(InputAction action) const { return down[action]; }
+
+    //Records the latency of the last poll's presses; call right after display()
+    void presented();
+    //Records one press seen on screen now, for presses that went through the simulation
+    void presented(InputAction action, std::chrono::steady_clock::time_point event);
+
+    const InputLatency& latency() const { return latencyStats; }
+    //Presses released within the same poll; sampling the keys once per frame misses these
+    unsigned long long shortTaps() const { return taps; }
+
+private:
+    void add(InputAction action, bool pressed, std::chrono::steady_clock::time_point time);
+    void handle(sf::RenderWindow& window, const sf::Event& event);
+
+    std::vector<InputEvent> frameEvents;
+    bool windowExposed = false;
+    bool down[ACTION_COUNT] = {};
+    InputLatency latencyStats;
+    unsigned long long taps = 0;
+};
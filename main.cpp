@@ -1,729 +1,887 @@
-#include <SFML/Graphics.hpp>
-#include <SFML/Audio.hpp>
-#include <vector>
-#include <algorithm>
-#include <cstdlib>
-#include <ctime>
-#include <iostream>
-#include <fstream>
-
-using namespace sf;
-using namespace std;
-
-const int WINDOW_WIDTH = 1920;
-const int WINDOW_HEIGHT = 1080;
-const int PLAYER_SPEED = 16;
-const int BULLET_SPEED = 15;
-const float ALIEN_SPAWN_INTERVAL = 2.0f;
-const int MAX_HEARTS = 3;
-const float HEART_SPAWN_INTERVAL = 7.0f;
-bool soundEnabled = true;
-
-//Levels and speed constants
-enum Level { EASY, MEDIUM, HARD };
-
-//Structures
-struct BonusHeart {
-    Sprite shape;
-    bool active = true;
-};
-
-struct Bullet {
-    RectangleShape shape;
-    bool active = true;
-};
-
-struct Alien {
-    Sprite alien;
-    bool active = true;
-};
-
-//Functions
-Level displayDifficultyPage(RenderWindow& window, Font& font);
-void displayHomePage(RenderWindow& window, Font& font);
-void displayOptionsMenu(RenderWindow& window, Font& font, bool& soundEnabled);
-void readHighScores(int highScores[]);
-void writeHighScores(const int highScores[]);
-
-//File to store high scores
-const string HIGH_SCORE_FILE = "texture/highscores.txt";
-
-//Main
-int main() {
-    srand(static_cast<unsigned>(time(nullptr)));
-
-    RenderWindow window(VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "RETRO BLASTERS", Style::Fullscreen);
-    window.setFramerateLimit(60);
-
-    Font font;
-    if (!font.loadFromFile("texture/font3.ttf")) {
-        cerr << "Error: Could not load font!" << endl;
-        return -1;
-    }
-
-    int score = 0;
-    int highScores[3] = { 0, 0, 0 };
-    readHighScores(highScores);
-
-
-    // Main game loop
-    bool playAgain = true;
-    while (playAgain && window.isOpen()) {
-        displayHomePage(window, font);
-        Level currentLevel = displayDifficultyPage(window, font);
-        score = 0;
-
-        int currentLevelIndex = 0;
-        int alienSpeed;
-        switch (currentLevel) {
-        case Level::EASY:
-            currentLevelIndex = 0;
-            alienSpeed = 6.0f;
-            break;
-        case Level::MEDIUM:
-            currentLevelIndex = 1;
-            alienSpeed = 8.0f;
-            break;
-        case Level::HARD:
-            currentLevelIndex = 2;
-            alienSpeed = 10.0f;
-            break;
-        }
-
-        // Load background texture
-        Texture backgroundTexture;
-        if (!backgroundTexture.loadFromFile("texture/back ground.jpg")) {
-            cerr << "Error: Could not load background texture!" << endl;
-            return -1;
-        }
-        Sprite background(backgroundTexture);
-        background.setScale(
-            static_cast<float>(WINDOW_WIDTH) / background.getLocalBounds().width,
-            static_cast<float>(WINDOW_HEIGHT) / background.getLocalBounds().height
-        );
-
-        // Player setup
-        Texture playerTexture;
-        if (!playerTexture.loadFromFile("texture/sprite.png")) {
-            cerr << "Error: Could not load player texture!" << endl;
-            return -1;
-        }
-        Sprite player(playerTexture);
-        player.setScale(0.1f, 0.1f);
-        player.setPosition(WINDOW_WIDTH / 2 - player.getGlobalBounds().width / 2, WINDOW_HEIGHT - player.getGlobalBounds().height - 10);
-
-        // Bullets
-        vector<Bullet> bullets;
-        Clock shootingClock;
-
-        // Aliens
-        vector<Alien> aliens;
-        Texture alienTexture;
-        if (!alienTexture.loadFromFile("texture/alien.png")) {
-            cerr << "Error: Could not load alien texture!" << endl;
-            return -1;
-        }
-        Sprite alienSprite(alienTexture);
-        alienSprite.setScale(0.1f, 0.1f);
-        Clock spawnClock;
-
-        // Hearts
-        int hearts = MAX_HEARTS;
-        Texture heartTexture;
-        if (!heartTexture.loadFromFile("texture/heart1.png")) {
-            cerr << "Error: Could not load heart texture!" << endl;
-            return -1;
-        }
-        Sprite heartSprite(heartTexture);
-        heartSprite.setScale(0.04f, 0.04f);
-
-        // Randomly generated hearts
-        vector<BonusHeart> bonusHearts;
-        Clock heartSpawnClock;
-
-        // Game Over image
-        Texture gameOverTexture;
-        if (!gameOverTexture.loadFromFile("texture/over.png")) {
-            cerr << "Error: Could not load Game Over image!" << endl;
-            return -1;
-        }
-        Sprite gameOverSprite(gameOverTexture);
-        gameOverSprite.setScale(1.5, 1.5);
-
-        // Declare sound buffers and sounds
-        SoundBuffer shootBuffer, alienDestroyedBuffer, gameOverBuffer, heartCollectedBuffer, navigationBuffer, selectionBuffer;
-        Sound shootSound, alienDestroyedSound, gameOverSound, heartCollectedSound, navigationSound, selectionSound;
-
-        // Load sound files
-        if (!shootBuffer.loadFromFile("texture/bullets.mp3") ||
-            !gameOverBuffer.loadFromFile("texture/gameover.mp3") ||
-            !heartCollectedBuffer.loadFromFile("texture/hrt pick.mp3")) {
-            cerr << "Error loading sound files!" << endl;
-            return -1;
-        }
-
-        // Assign buffers to sounds
-        shootSound.setBuffer(shootBuffer);
-        gameOverSound.setBuffer(gameOverBuffer);
-        heartCollectedSound.setBuffer(heartCollectedBuffer);
-
-        Music backgroundMusic;
-        if (!backgroundMusic.openFromFile("texture/background sound.mp3")) {
-            cerr << "Error loading background music!" << endl;
-            return -1;
-        }
-        backgroundMusic.setLoop(true);
-        if (soundEnabled) {
-            backgroundMusic.play();
-        }
-
-        // Game loop
-        score = 0;
-        while (window.isOpen()) {
-            Event event;
-            while (window.pollEvent(event)) {
-                if (event.type == Event::Closed)
-                    window.close();
-            }
-            if (Keyboard::isKeyPressed(Keyboard::Escape)) {
-                window.close();
-            }
-            // Player movement
-            if (Keyboard::isKeyPressed(Keyboard::Left) && player.getPosition().x > 0) {
-                player.move(-PLAYER_SPEED, 0);
-            }
-            if (Keyboard::isKeyPressed(Keyboard::Right) && player.getPosition().x + player.getGlobalBounds().width < WINDOW_WIDTH) {
-                player.move(PLAYER_SPEED, 0);
-            }
-            if (Keyboard::isKeyPressed(Keyboard::Up) && player.getPosition().y > 0) {
-                player.move(0, -PLAYER_SPEED);
-            }
-            if (Keyboard::isKeyPressed(Keyboard::Down) && player.getPosition().y + player.getGlobalBounds().height < WINDOW_HEIGHT) {
-                player.move(0, PLAYER_SPEED);
-            }
-
-            // Spawn aliens
-            if (spawnClock.getElapsedTime().asSeconds() >= ALIEN_SPAWN_INTERVAL) {
-                Alien alien;
-                alien.alien.setTexture(alienTexture);
-                alien.alien.setScale(0.1f, 0.1f);
-                float xPosition = static_cast<float>(rand() % (WINDOW_WIDTH - static_cast<int>(alien.alien.getGlobalBounds().width)));
-                alien.alien.setPosition(xPosition, -alien.alien.getGlobalBounds().width);
-                aliens.push_back(alien);
-                spawnClock.restart();
-            }
-
-            //Spawn hearts
-            if (heartSpawnClock.getElapsedTime().asSeconds() >= HEART_SPAWN_INTERVAL) {
-                BonusHeart newHeart;
-                newHeart.shape.setTexture(heartTexture);
-                newHeart.shape.setScale(0.04f, 0.04f);
-                float xPosition = static_cast<float>(rand() % (WINDOW_WIDTH - static_cast<int>(newHeart.shape.getGlobalBounds().width)));
-                newHeart.shape.setPosition(xPosition, -newHeart.shape.getGlobalBounds().height);
-                bonusHearts.push_back(newHeart);
-                heartSpawnClock.restart();
-            }
-
-            // Shooting bullets
-            if (Keyboard::isKeyPressed(Keyboard::Space) && bullets.size() < 5) {
-                if (shootingClock.getElapsedTime().asSeconds() >= 0.2f) {
-                    if (soundEnabled) {
-                        shootSound.play();
-                    }
-                    Bullet bullet;
-                    bullet.shape.setSize(Vector2f(2, 30));
-                    bullet.shape.setFillColor(Color::Green);
-                    bullet.shape.setPosition(player.getPosition().x + player.getGlobalBounds().width / 2 - 2.5f, player.getPosition().y);
-                    bullets.push_back(bullet);
-                    shootingClock.restart();
-                }
-            }
-
-            // Move bullets
-            for (auto& bullet : bullets) {
-                if (bullet.active) {
-                    bullet.shape.move(0, -BULLET_SPEED);
-                    if (bullet.shape.getPosition().y < 0) {
-                        bullet.active = false;
-                    }
-                }
-            }
-            bullets.erase(remove_if(bullets.begin(), bullets.end(), [](const Bullet& b) { return !b.active; }), bullets.end());
-
-            // Move aliens
-            for (auto& alien : aliens) {
-                if (alien.active) {
-                    alien.alien.move(0, alienSpeed);
-                    if (alien.alien.getPosition().x + alien.alien.getGlobalBounds().width < 0 || alien.alien.getPosition().y > WINDOW_HEIGHT) {
-                        alien.active = false;
-                        hearts--;
-                    }
-                }
-            }
-
-            // Remove inactive aliens
-            aliens.erase(remove_if(aliens.begin(), aliens.end(), [](const Alien& a) { return !a.active; }), aliens.end());
-
-            //Move hearts
-            for (auto& heart : bonusHearts) {
-                if (heart.active) {
-                    heart.shape.move(0, alienSpeed);
-                    if (heart.shape.getPosition().y > WINDOW_HEIGHT) {
-                        heart.active = false;
-                    }
-                }
-            }
-            bonusHearts.erase(remove_if(bonusHearts.begin(), bonusHearts.end(), [](const BonusHeart& h) { return !h.active; }), bonusHearts.end());
-
-            // Check collisions
-            for (auto& bullet : bullets) {
-                for (auto& alien : aliens) {
-                    if (bullet.active && alien.active && bullet.shape.getGlobalBounds().intersects(alien.alien.getGlobalBounds())) {
-                        bullet.active = false;
-                        alien.active = false;
-                        score++;
-                    }
-                }
-            }
-
-            // Collision with player (alien collides with spaceship)
-            for (auto& alien : aliens) {
-                if (alien.active && player.getGlobalBounds().intersects(alien.alien.getGlobalBounds())) {
-                    alien.active = false;
-                    hearts--;
-                }
-            }
-
-            //Collision of hearts with player
-            for (auto& heart : bonusHearts) {
-                if (heart.active && player.getGlobalBounds().intersects(heart.shape.getGlobalBounds())) {
-                    heart.active = false;
-                    if (hearts < MAX_HEARTS) {
-                        hearts++;
-
-                        if (soundEnabled) {
-                            heartCollectedSound.play();
-                        }
-                    }
-                }
-            }
-
-            // Render
-            window.clear();
-            window.draw(background);
-            window.draw(player);
-
-            for (const auto& bullet : bullets) {
-                window.draw(bullet.shape);
-            }
-
-            for (const auto& alien : aliens) {
-                window.draw(alien.alien);
-            }
-
-            // Display hearts
-            for (int i = 0; i < hearts; i++) {
-                heartSprite.setPosition(10 + (i * (heartSprite.getGlobalBounds().width + 5)), 10);
-                window.draw(heartSprite);
-            }
-
-            //Display score and high score
-            Text scoreText;
-            scoreText.setFont(font);
-            scoreText.setCharacterSize(60);
-            scoreText.setFillColor(Color::White);
-            scoreText.setString("Score: " + to_string(score));
-            scoreText.setPosition(800, 10);
-            window.draw(scoreText);
-
-            Text highScoreText;
-            highScoreText.setFont(font);
-            highScoreText.setCharacterSize(60);
-            highScoreText.setFillColor(Color::White);
-            highScoreText.setString("Highest Score: " + to_string(highScores[currentLevelIndex]));
-            highScoreText.setPosition(1300, 10);
-            window.draw(highScoreText);
-
-            //Display spawning hearts
-            for (const auto& heart : bonusHearts) {
-                if (heart.active) {
-                    window.draw(heart.shape);
-                }
-            }
-
-            window.display();
-
-            // Update the high score for the current level
-            if (hearts <= 0) {
-                if (score > highScores[currentLevelIndex]) {
-                    highScores[currentLevelIndex] = score;
-                    writeHighScores(highScores);
-                }
-                scoreText.setString("Your Score: " + to_string(score));
-                scoreText.setPosition(100, 10);
-
-                if (soundEnabled) {
-                    gameOverSound.play();
-                    backgroundMusic.stop();
-                }
-                window.clear();
-                gameOverSprite.setPosition(700, 350);
-                window.draw(gameOverSprite);
-                window.draw(scoreText);
-                window.draw(highScoreText);
-                window.display();
-
-                bool waitingForInput = true;
-                while (waitingForInput) {
-                    Event event;
-                    while (window.pollEvent(event)) {
-                        if (event.type == Event::Closed || (event.type == Event::KeyPressed)) {
-                            waitingForInput = false;
-                            playAgain = true;
-
-                            currentLevel = displayDifficultyPage(window, font);
-                            currentLevelIndex = (currentLevel == Level::EASY ? 0 : (currentLevel == Level::MEDIUM ? 1 : 2));
-
-                            switch (currentLevel) {
-                            case Level::EASY:
-                                alienSpeed = 6.0f;
-                                break;
-                            case Level::MEDIUM:
-                                alienSpeed = 8.0f;
-                                break;
-                            case Level::HARD:
-                                alienSpeed = 10.0f;
-                                break;
-                            }
-
-                            // Reset the game variables (e.g., hearts, player position, etc.)
-                            hearts = MAX_HEARTS;
-                            score = 0;
-                            aliens.clear();
-                            bullets.clear();
-                            player.setPosition(WINDOW_WIDTH / 2 - player.getGlobalBounds().width / 2, WINDOW_HEIGHT - player.getGlobalBounds().height - 10);
-                            spawnClock.restart();
-                            if (soundEnabled) {
-                                backgroundMusic.play();
-                            }
-                        }
-                    }
-                }
-            }
-
-        }
-    }
-    return 0;
-}
-
-// Function to display the difficulty level selection page
-Level displayDifficultyPage(RenderWindow& window, Font& font) {
-    Texture difficultyTexture;
-    if (!difficultyTexture.loadFromFile("texture/main page.jpg")) {
-        cerr << "Error: Could not load difficulty background texture!" << endl;
-    }
-    Sprite difficultyPage(difficultyTexture);
-    difficultyPage.setScale(
-        static_cast<float>(WINDOW_WIDTH) / difficultyPage.getLocalBounds().width,
-        static_cast<float>(WINDOW_HEIGHT) / difficultyPage.getLocalBounds().height
-    );
-
-    Text easyText("EASY", font, 90);
-    easyText.setPosition(880, 700);
-    easyText.setFillColor(Color::Red);
-
-    Text mediumText("MEDIUM", font, 90);
-    mediumText.setPosition(830, 800);
-    mediumText.setFillColor(Color::White);
-
-    Text hardText("HARD", font, 90);
-    hardText.setPosition(880, 900);
-    hardText.setFillColor(Color::White);
-
-    Text endText("Click BackSpace to return to main page.", font, 40);
-    endText.setPosition(585, 1000);
-    endText.setFillColor(Color::Black);
-
-    SoundBuffer navigationBuffer, selectionBuffer;
-    Sound navigationSound, selectionSound;
-
-    if (!navigationBuffer.loadFromFile("texture/navigation.mp3") ||
-        !selectionBuffer.loadFromFile("texture/selection.mp3")) {
-        cerr << "Error loading sound files for navigation or selection!" << endl;
-    }
-
-    navigationSound.setBuffer(navigationBuffer);
-    selectionSound.setBuffer(selectionBuffer);
-
-    Level selectedLevel = Level::EASY;
-    bool selecting = true;
-
-    while (selecting) {
-        Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == Event::Closed)
-                window.close();
-
-            if (event.type == Event::KeyPressed) {
-                if (event.key.code == Keyboard::Escape) {
-                    window.close();
-                }
-                if (event.key.code == Keyboard::BackSpace) {
-                    displayHomePage(window, font);
-                }
-
-                if (event.key.code == Keyboard::Up) {
-                    if (selectedLevel == Level::MEDIUM) {
-                        selectedLevel = Level::EASY;
-                        navigationSound.play();
-                    }
-                    else if (selectedLevel == Level::HARD) {
-                        selectedLevel = Level::MEDIUM;
-                        navigationSound.play();
-                    }
-                }
-
-                if (event.key.code == Keyboard::Down) {
-                    if (selectedLevel == Level::EASY) {
-                        selectedLevel = Level::MEDIUM;
-                        navigationSound.play();
-                    }
-                    else if (selectedLevel == Level::MEDIUM) {
-                        selectedLevel = Level::HARD;
-                        navigationSound.play();
-                    }
-                }
-
-                if (event.key.code == Keyboard::Enter) {
-                    selecting = false;
-                }
-            }
-        }
-
-        // Render difficulty page
-        window.clear();
-        window.draw(difficultyPage);
-        window.draw(easyText);
-        window.draw(mediumText);
-        window.draw(hardText);
-        window.draw(endText);
-
-        //Difficulty
-        if (selectedLevel == Level::EASY)
-            easyText.setFillColor(Color::Red);
-        else
-            easyText.setFillColor(Color::White);
-
-        if (selectedLevel == Level::MEDIUM)
-            mediumText.setFillColor(Color::Red);
-        else
-            mediumText.setFillColor(Color::White);
-
-        if (selectedLevel == Level::HARD)
-            hardText.setFillColor(Color::Red);
-        else
-            hardText.setFillColor(Color::White);
-
-        window.display();
-    }
-    return selectedLevel;
-}
-
-// Function to display the home page with buttons
-void displayHomePage(RenderWindow& window, Font& font) {
-    Texture homeTexture;
-    if (!homeTexture.loadFromFile("texture/main page.jpg")) {
-        cerr << "Error: Could not load background texture!" << endl;
-    }
-    Sprite homePage(homeTexture);
-    homePage.setScale(
-        static_cast<float>(WINDOW_WIDTH) / homePage.getLocalBounds().width,
-        static_cast<float>(WINDOW_HEIGHT) / homePage.getLocalBounds().height
-    );
-
-    Text startText("START", font, 70);
-    startText.setPosition(880, 750);
-    startText.setFillColor(Color::Red);
-
-    Text optionsText("OPTIONS", font, 70);
-    optionsText.setPosition(850, 850);
-    optionsText.setFillColor(Color::White);
-
-    Text exitText("EXIT", font, 70);
-    exitText.setPosition(900, 950);
-    exitText.setFillColor(Color::White);
-
-    SoundBuffer navigationBuffer, selectionBuffer;
-    Sound navigationSound, selectionSound;
-
-    if (!navigationBuffer.loadFromFile("texture/navigation.mp3") ||
-        !selectionBuffer.loadFromFile("texture/selection.mp3")) {
-        cerr << "Error loading sound files for navigation or selection!" << endl;
-    }
-
-    navigationSound.setBuffer(navigationBuffer);
-    selectionSound.setBuffer(selectionBuffer);
-
-    int selectedOption = 0;
-    bool selectingMain = true;
-
-    while (selectingMain) {
-        Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == Event::Closed)
-                window.close();
-
-            if (event.type == Event::KeyPressed) {
-                if (event.key.code == Keyboard::Escape) {
-                    window.close();
-                }
-                if (event.key.code == Keyboard::Up) {
-                    selectedOption = (selectedOption - 1 + 3) % 3;
-                    navigationSound.play();
-                }
-                if (event.key.code == Keyboard::Down) {
-                    selectedOption = (selectedOption + 1) % 3;
-                    navigationSound.play();
-                }
-                if (event.key.code == Keyboard::Enter) {
-                    switch (selectedOption) {
-                    case 0:
-                        selectionSound.play();
-                        selectingMain = false;
-                        break;
-                    case 1:
-                        selectionSound.play();
-                        displayOptionsMenu(window, font, soundEnabled);
-                        break;
-                    case 2:
-                        selectionSound.play();
-                        window.close();
-                        break;
-                    }
-                }
-            }
-        }
-
-        startText.setFillColor(selectedOption == 0 ? Color::Red : Color::White);
-        optionsText.setFillColor(selectedOption == 1 ? Color::Red : Color::White);
-        exitText.setFillColor(selectedOption == 2 ? Color::Red : Color::White);
-
-        // Render home page
-        window.clear();
-        window.draw(homePage);
-        window.draw(startText);
-        window.draw(optionsText);
-        window.draw(exitText);
-        window.display();
-    }
-}
-
-// Function to display option menu
-void displayOptionsMenu(RenderWindow& window, Font& font, bool& soundEnabled) {
-    Texture optionsTexture;
-    if (!optionsTexture.loadFromFile("texture/main page.jpg")) {
-        cerr << "Error: Could not load options background texture!" << endl;
-    }
-    Sprite optionsPage(optionsTexture);
-    optionsPage.setScale(
-        static_cast<float>(WINDOW_WIDTH) / optionsPage.getLocalBounds().width,
-        static_cast<float>(WINDOW_HEIGHT) / optionsPage.getLocalBounds().height
-    );
-
-    Text soundText("SOUND: " + string(soundEnabled ? "ON" : "OFF"), font, 70);
-    soundText.setPosition(800, 750);
-    soundText.setFillColor(Color::Red);
-
-    Text backText("BACK", font, 70);
-    backText.setPosition(880, 850);
-    backText.setFillColor(Color::White);
-
-
-    SoundBuffer navigationBuffer, selectionBuffer;
-    Sound navigationSound, selectionSound;
-
-    if (!navigationBuffer.loadFromFile("texture/navigation.mp3") ||
-        !selectionBuffer.loadFromFile("texture/selection.mp3")) {
-        cerr << "Error loading sound files for navigation or selection!" << endl;
-    }
-
-    navigationSound.setBuffer(navigationBuffer);
-    selectionSound.setBuffer(selectionBuffer);
-
-    bool selecting = true;
-    while (selecting) {
-        Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == Event::KeyPressed) {
-                if (event.key.code == Keyboard::Up || event.key.code == Keyboard::Down) {
-                    if (soundText.getFillColor() == Color::Red) {
-                        soundText.setFillColor(Color::White);
-                        backText.setFillColor(Color::Red);
-                        navigationSound.play();
-                    }
-                    else {
-                        soundText.setFillColor(Color::Red);
-                        backText.setFillColor(Color::White);
-                        navigationSound.play();
-                    }
-                }
-                if (event.key.code == Keyboard::Enter) {
-                    if (soundText.getFillColor() == Color::Red) {
-                        soundEnabled = !soundEnabled;
-                        soundText.setString("SOUND: " + string(soundEnabled ? "ON" : "OFF"));
-                        selectionSound.play();
-                    }
-                    else if (backText.getFillColor() == Color::Red) {
-                        selecting = false;
-                        selectionSound.play();
-                    }
-                }
-                if (event.key.code == Keyboard::Escape) {
-                    selecting = false;
-                }
-            }
-        }
-
-        window.clear();
-        window.draw(optionsPage);
-        window.draw(soundText);
-        window.draw(backText);
-        window.display();
-    }
-}
-
-//Function to read high score
-void readHighScores(int highScores[]) {
-    ifstream inFile(HIGH_SCORE_FILE);
-    if (inFile.is_open()) {
-        string line;
-        while (getline(inFile, line)) {
-            if (line.find("Easy:") == 0) {
-                highScores[0] = stoi(line.substr(5));
-            }
-            else if (line.find("Medium:") == 0) {
-                highScores[1] = stoi(line.substr(7));
-            }
-            else if (line.find("Hard:") == 0) {
-                highScores[2] = stoi(line.substr(5));
-            }
-        }
-        inFile.close();
-    }
-    else {
-        for (int i = 0; i < 3; i++) {
-            highScores[i] = 0;
-        }
-    }
-}
-
-//Function to write high score
-void writeHighScores(const int highScores[]) {
-    ofstream outFile(HIGH_SCORE_FILE);
-    if (outFile.is_open()) {
-        outFile << "Easy: " << highScores[0] << endl;
-        outFile << "Medium: " << highScores[1] << endl;
-        outFile << "Hard: " << highScores[2] << endl;
-        outFile.close();
-    }
-}
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <fstream>
+#include "audio.h"
+#include "game.h"
+#include "render.h"
+#include "resources.h"
+#include "hud.h"
+#include "particles.h"
+#include "keyboard.h"
+#include "replay.h"
+#include "resolution.h"
+#include "savestate.h"
+#include "scores.h"
+#include "snapshot.h"
+
+using namespace sf;
+using namespace std;
+
+bool soundEnabled = true;
+
+//Functions
+Level displayDifficultyPage(RenderWindow& window, Font& font, ResourceCache& resources, AudioSystem& audio, InputSystem& input);
+void displayHomePage(RenderWindow& window, Font& font, ResourceCache& resources, AudioSystem& audio, InputSystem& input);
+void displayOptionsMenu(RenderWindow& window, Font& font, ResourceCache& resources, AudioSystem& audio, InputSystem& input, bool& soundEnabled);
+void importHighScores(ScoreStore& scores);
+CollisionMask spriteMask(const Sprite& sprite);
+
+//Scores are kept in texture/scores.journal and texture/scores.index
+const string SCORE_DIRECTORY = "texture";
+//Written by the packer tool; loose files are used for anything not in it
+const string ASSET_PACK_FILE = "texture/assets.pack";
+//Written when quitting mid-game and every few seconds of play; a game left in it resumes at the next start
+const string SUSPEND_FILE = "texture/suspend.state";
+//Old single-line-per-level file, imported once into the score store
+const string HIGH_SCORE_FILE = "texture/highscores.txt";
+
+//Main
+int main(int argc, char* argv[]) {
+    // --record <file> saves the inputs of each game, --replay <file> plays one back,
+    // --waves <file> spawns from a wave script instead of the built-in clocks,
+    // --render-budget <ms> sets the frame time the playfield resolution adapts to (0 keeps full resolution)
+    string recordPath, replayPath, wavesPath;
+    float renderBudget = DEFAULT_RENDER_BUDGET_MS;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (string(argv[i]) == "--record") recordPath = argv[i + 1];
+        if (string(argv[i]) == "--replay") replayPath = argv[i + 1];
+        if (string(argv[i]) == "--waves") wavesPath = argv[i + 1];
+        if (string(argv[i]) == "--render-budget") renderBudget = static_cast<float>(atof(argv[i + 1]));
+    }
+    SpawnTimeline waves;
+    if (!wavesPath.empty() && !loadTimeline(wavesPath, waves)) {
+        return -1;
+    }
+    Replay replay;
+    bool replaying = !replayPath.empty();
+    if (replaying && !loadReplay(replayPath, replay)) {
+        cerr << "Error: Could not load replay " << replayPath << endl;
+        return -1;
+    }
+    unsigned long long nextSeed = static_cast<unsigned long long>(time(nullptr));
+
+    RenderWindow window(VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "RETRO BLASTERS", Style::Fullscreen);
+    window.setFramerateLimit(60);
+
+    // Every asset is loaded once and shared between menus and replays
+    ResourceCache resources;
+    resources.mount(ASSET_PACK_FILE);
+    Font* fontAsset = resources.font("texture/font3.ttf");
+    if (!fontAsset) {
+        cerr << "Error: Could not load font!" << endl;
+        return -1;
+    }
+    Font& font = *fontAsset;
+
+    // Decode everything else on worker threads while the home page is already up
+    resources.preload({
+        "texture/main page.jpg", "texture/navigation.mp3", "texture/selection.mp3",
+        "texture/back ground.jpg", "texture/sprite.png", "texture/alien.png", "texture/heart1.png", "texture/over.png",
+        "texture/bullets.mp3", "texture/gameover.mp3", "texture/hrt pick.mp3"
+    });
+
+    // Sound effects play on the audio thread from a fixed pool of voices.
+    // Declared after the cache so it stops before the buffers go away.
+    AudioSystem audio;
+    SoundBuffer* navigationBuffer = resources.sound("texture/navigation.mp3");
+    SoundBuffer* selectionBuffer = resources.sound("texture/selection.mp3");
+    if (!navigationBuffer || !selectionBuffer) {
+        cerr << "Error loading sound files for navigation or selection!" << endl;
+    }
+    audio.setEffect(SFX_NAVIGATION, navigationBuffer, 2, 2);
+    audio.setEffect(SFX_SELECTION, selectionBuffer, 2, 1);
+
+    // Key events for menus and gameplay, stamped as they are drained
+    InputSystem input;
+
+    // Frame timings per phase; F3 toggles the overlay, the CSVs are written on exit.
+    // The simulation thread has its own profiler, one frame per tick.
+    Profiler profiler;
+    Profiler simProfiler;
+    ProfilerOverlay profilerOverlay(font, profiler);
+    profilerOverlay.setSimProfiler(&simProfiler);
+
+    // Worker threads for large entity passes; small waves stay on the simulation thread
+    JobSystem jobs;
+
+    // Hit, pickup and shot effects; every particle array is allocated once here
+    ParticleSystem particles;
+
+    // Pixel masks of the colliding sprites at their drawn size, built from the
+    // first game's textures; replays collide on the masks they were recorded with
+    CollisionMasks masks;
+
+    // The playfield is drawn into an off-screen texture whose used area follows
+    // the render budget and is stretched over the window. Logical coordinates
+    // never change. Without render textures it is drawn straight to the window.
+    ResolutionScaler resolution(renderBudget);
+    ScaledTarget playfield;
+    bool scaledPlayfield = playfield.create(WINDOW_WIDTH, WINDOW_HEIGHT);
+
+    // Scores are written by the store's own thread, so game over never waits on the disk
+    ScoreStore scores(SCORE_DIRECTORY);
+    scores.open();
+    if (scores.totalEntries() == 0) {
+        importHighScores(scores);
+    }
+    int highScores[3] = { 0, 0, 0 };
+    for (int i = 0; i < 3; i++) {
+        highScores[i] = scores.best(Level(i));
+    }
+
+
+    // A game that was quit or crashed out of carries on where it stopped. Damaged
+    // files never load, and a scratch restore checks the wave script before the menus are skipped
+    SaveState suspended;
+    bool resuming = false;
+    if (!replaying && loadStateFile(SUSPEND_FILE, suspended)) {
+        Game probe;
+        if (!wavesPath.empty()) {
+            probe.timeline = &waves;
+        }
+        resuming = suspended.restore(probe);
+        if (!resuming) {
+            cerr << "Error: " << SUSPEND_FILE << " was saved on another wave script; starting a new game" << endl;
+        }
+    }
+    // Autosaves and suspends go to disk from the writer's own thread
+    StateWriter suspendWriter(SUSPEND_FILE);
+
+    // Main game loop
+    bool playAgain = true;
+    while (playAgain && window.isOpen()) {
+        Level currentLevel = replay.config.level;
+        if (!replaying && !resuming) {
+            displayHomePage(window, font, resources, audio, input);
+            currentLevel = displayDifficultyPage(window, font, resources, audio, input);
+        }
+        int currentLevelIndex = static_cast<int>(currentLevel);
+
+        // Load background texture
+        Texture* backgroundTexture = resources.texture("texture/back ground.jpg");
+        if (!backgroundTexture) {
+            cerr << "Error: Could not load background texture!" << endl;
+            return -1;
+        }
+        Sprite background(*backgroundTexture);
+        background.setScale(
+            static_cast<float>(WINDOW_WIDTH) / background.getLocalBounds().width,
+            static_cast<float>(WINDOW_HEIGHT) / background.getLocalBounds().height
+        );
+
+        // Player setup
+        Texture* playerTexture = resources.texture("texture/sprite.png");
+        if (!playerTexture) {
+            cerr << "Error: Could not load player texture!" << endl;
+            return -1;
+        }
+        Sprite player(*playerTexture);
+        player.setScale(0.1f, 0.1f);
+
+        // Aliens
+        Texture* alienTexture = resources.texture("texture/alien.png");
+        if (!alienTexture) {
+            cerr << "Error: Could not load alien texture!" << endl;
+            return -1;
+        }
+        Sprite alienSprite(*alienTexture);
+        alienSprite.setScale(0.1f, 0.1f);
+
+        // Hearts
+        Texture* heartTexture = resources.texture("texture/heart1.png");
+        if (!heartTexture) {
+            cerr << "Error: Could not load heart texture!" << endl;
+            return -1;
+        }
+        Sprite heartSprite(*heartTexture);
+        heartSprite.setScale(0.04f, 0.04f);
+
+        // Game Over image
+        Texture* gameOverTexture = resources.texture("texture/over.png");
+        if (!gameOverTexture) {
+            cerr << "Error: Could not load Game Over image!" << endl;
+            return -1;
+        }
+        Sprite gameOverSprite(*gameOverTexture);
+        gameOverSprite.setScale(1.5, 1.5);
+
+        // Declare sound buffers and sounds
+        SoundBuffer* shootBuffer = resources.sound("texture/bullets.mp3");
+        SoundBuffer* gameOverBuffer = resources.sound("texture/gameover.mp3");
+        SoundBuffer* heartCollectedBuffer = resources.sound("texture/hrt pick.mp3");
+        if (!shootBuffer || !gameOverBuffer || !heartCollectedBuffer) {
+            cerr << "Error loading sound files!" << endl;
+            return -1;
+        }
+
+        // Rapid fire overlaps up to four shots; game over outranks everything
+        audio.setEffect(SFX_SHOOT, shootBuffer, 1, 4);
+        audio.setEffect(SFX_HEART, heartCollectedBuffer, 2, 2);
+        audio.setEffect(SFX_GAME_OVER, gameOverBuffer, 3, 1);
+
+        Music* backgroundMusicAsset = resources.music("texture/background sound.mp3");
+        if (!backgroundMusicAsset) {
+            cerr << "Error loading background music!" << endl;
+            return -1;
+        }
+        Music& backgroundMusic = *backgroundMusicAsset;
+        backgroundMusic.setLoop(true);
+        if (soundEnabled) {
+            backgroundMusic.play();
+        }
+
+        // Simulation state, sized from the scaled textures
+        GameConfig config = defaultConfig(currentLevel);
+        config.playerWidth = player.getGlobalBounds().width;
+        config.playerHeight = player.getGlobalBounds().height;
+        config.alienWidth = alienSprite.getGlobalBounds().width;
+        config.alienHeight = alienSprite.getGlobalBounds().height;
+        config.heartWidth = heartSprite.getGlobalBounds().width;
+        config.heartHeight = heartSprite.getGlobalBounds().height;
+        if (masks.empty()) {
+            masks.player = spriteMask(player);
+            masks.alien = spriteMask(alienSprite);
+            masks.heart = spriteMask(heartSprite);
+        }
+
+        Game game;
+        game.masks = &masks;
+        if (replaying) {
+            config = replay.config;
+            game.timeline = &replay.timeline;
+            game.masks = &replay.masks;
+            resetGame(game, config, replay.seed);
+        }
+        else {
+            if (!wavesPath.empty()) {
+                game.timeline = &waves;
+            }
+            resetGame(game, config, nextSeed++);
+            if (resuming && suspended.restore(game)) {
+                config = game.config;
+                currentLevel = config.level;
+                currentLevelIndex = static_cast<int>(currentLevel);
+                cout << "Resumed suspended game at tick " << game.tick << endl;
+            }
+            resuming = false;
+        }
+        game.jobs = &jobs;
+        //Replays start at tick 0, so a resumed game is not recorded
+        bool recordGame = !recordPath.empty() && game.tick == 0;
+        Replay recording;
+        recording.begin(game);
+
+        SpriteBatch bulletBatch;
+        SpriteBatch alienBatch(alienTexture);
+        SpriteBatch heartBatch(heartTexture);
+        SpriteBatch hudHeartBatch(heartTexture);
+        SpriteBatch particleBatch;
+        particles.clear();
+        auto lastFrame = chrono::steady_clock::now();
+        RenderStats renderStats;
+        Hud hud(font);
+        // Only counts anything in -DALLOC_DEBUG builds, and only this thread's
+        // allocations, not the simulation thread's or the autosave writer's
+        AllocFrameMonitor frameAllocs("render");
+
+        // The simulation ticks on its own thread; this thread polls input and
+        // draws the newest snapshot, interpolated, at the display's refresh rate
+        SimThread sim(game, &simProfiler);
+        sim.setAutosave(replaying ? nullptr : &suspendWriter);
+        sim.start(replaying ? &replay : nullptr, recordGame ? &recording : nullptr);
+        unsigned shotsHeard = 0;
+        unsigned heartsHeard = 0;
+        unsigned pressesSeen[ACTION_COUNT] = {};
+        window.setFramerateLimit(0);
+        window.setVerticalSyncEnabled(true);
+
+        while (window.isOpen()) {
+            auto frameStart = chrono::steady_clock::now();
+            profiler.beginFrame();
+            frameAllocs.beginFrame();
+            {
+                ProfileScope scope(&profiler, PHASE_EVENTS);
+                // Every key event goes to the simulation with its timestamp, so taps
+                // shorter than a frame still reach a tick
+                input.poll(window);
+                for (const InputEvent& event : input.events()) {
+                    if (event.pressed && event.action == ACTION_PROFILER)
+                        profilerOverlay.toggle();
+                    if (event.pressed && event.action == ACTION_QUIT)
+                        window.close();
+                    // Backspace steps the game back a second at a time
+                    if (event.pressed && event.action == ACTION_BACK && !replaying)
+                        sim.requestRewind(REWIND_STEP_TICKS);
+                    if (actionInputBit(event.action)) {
+                        sim.pushInput(event);
+                    }
+                }
+            }
+
+            sim.snapshots().update();
+            const GameSnapshot& snapshot = sim.snapshots().readBuffer();
+            profilerOverlay.setJobTimings(&snapshot.jobTimings);
+
+            for (; soundEnabled && shotsHeard != snapshot.shotsFired; shotsHeard++) {
+                audio.trigger(SFX_SHOOT);
+            }
+            for (; soundEnabled && heartsHeard != snapshot.heartsCollected; heartsHeard++) {
+                audio.trigger(SFX_HEART);
+            }
+            shotsHeard = snapshot.shotsFired;
+            heartsHeard = snapshot.heartsCollected;
+
+            // Effects burst from this frame's hits and pickups and move in real time.
+            // Their cost, batching included, is held to the particle budget.
+            {
+                ProfileScope scope(&profiler, PHASE_PARTICLES);
+                auto particleStart = chrono::steady_clock::now();
+                float frameDt = min(chrono::duration<float>(particleStart - lastFrame).count(), 0.1f);
+                lastFrame = particleStart;
+                GameEffect effect;
+                while (sim.effects().pop(effect)) {
+                    particles.emit(effect);
+                }
+                particles.update(frameDt);
+                particleBatch.clear();
+                particleBatch.addParticles(particles);
+                particles.adapt(chrono::duration<float, milli>(chrono::steady_clock::now() - particleStart).count());
+            }
+
+            // Render: one batched draw call per entity kind, drawn between the last two ticks
+            {
+                ProfileScope scope(&profiler, PHASE_RENDER);
+                auto renderStart = chrono::steady_clock::now();
+                float alpha = snapshot.alpha(renderStart);
+                float lag = (1 - alpha) * TICK_DT;
+                renderStats.beginFrame();
+                window.clear();
+                RenderTarget& field = scaledPlayfield ? playfield.begin(resolution.scale()) : static_cast<RenderTarget&>(window);
+                drawCounted(field, background, renderStats);
+                player.setPosition(snapshot.prevPlayerX + (snapshot.playerX - snapshot.prevPlayerX) * alpha,
+                                   snapshot.prevPlayerY + (snapshot.playerY - snapshot.prevPlayerY) * alpha);
+                drawCounted(field, player, renderStats);
+
+                bulletBatch.clear();
+                bulletBatch.addEntities(snapshot.bullets, lag, Color::Green);
+                bulletBatch.draw(field, renderStats);
+
+                alienBatch.clear();
+                alienBatch.addEntities(snapshot.aliens, lag);
+                alienBatch.draw(field, renderStats);
+                particleBatch.draw(field, renderStats);
+
+                // Falling bonus hearts are part of the playfield
+                heartBatch.clear();
+                heartBatch.addEntities(snapshot.bonusHearts, lag);
+                heartBatch.draw(field, renderStats);
+
+                if (scaledPlayfield) {
+                    playfield.present(window, renderStats);
+                }
+
+                //Display hearts, score and high score at full resolution over the upscaled playfield;
+                //text is only re-laid out when a value changes
+                hudHeartBatch.clear();
+                float heartWidth = heartSprite.getGlobalBounds().width;
+                float heartHeight = heartSprite.getGlobalBounds().height;
+                for (int i = 0; i < snapshot.hearts; i++) {
+                    hudHeartBatch.add(10 + (i * (heartWidth + 5)), 10, heartWidth, heartHeight);
+                }
+                hudHeartBatch.draw(window, renderStats);
+                hud.setScore(snapshot.score);
+                hud.setHighScore(highScores[currentLevelIndex]);
+                hud.draw(window, renderStats);
+
+                profilerOverlay.draw(window, renderStats);
+                renderStats.endFrame();
+                // The budget covers the whole frame up to the swap. Drivers may defer
+                // rasterizing to the swap, so wait for it here, where the vsync wait is not included
+                if (scaledPlayfield && resolution.budget() > 0) {
+                    finishRendering();
+                }
+                resolution.update(chrono::duration<float, milli>(chrono::steady_clock::now() - frameStart).count());
+            }
+            {
+                ProfileScope scope(&profiler, PHASE_DISPLAY);
+                window.display();
+            }
+            for (int action = 0; action < ACTION_COUNT; action++) {
+                if (pressesSeen[action] != snapshot.presses[action]) {
+                    input.presented(static_cast<InputAction>(action), snapshot.pressTime[action]);
+                    pressesSeen[action] = snapshot.presses[action];
+                }
+            }
+            frameAllocs.endFrame();
+            profiler.endFrame();
+
+            // From here on the game state belongs to this thread again
+            if (!sim.finished() && window.isOpen()) {
+                continue;
+            }
+            sim.stop();
+            profilerOverlay.setJobTimings(nullptr);
+
+            // Quitting mid-game suspends it to disk; finishing it clears the suspended game
+            if (!replaying) {
+                if (game.over) {
+                    suspendWriter.discard();
+                }
+                else {
+                    SaveState state;
+                    state.capture(game);
+                    suspendWriter.submit(state);
+                    cout << "Game suspended at tick " << game.tick << endl;
+                }
+            }
+
+            // A finished replay is checked against its recorded end state
+            if (replaying && window.isOpen()) {
+                unsigned long long checksum = gameChecksum(game);
+                cout << "Replay " << (checksum == replay.checksum ? "OK" : "MISMATCH") << ": checksum " << hex << checksum
+                     << " expected " << replay.checksum << dec << endl;
+                window.close();
+                break;
+            }
+
+            // Update the high score for the current level
+            if (game.over) {
+                // Menus go back to a plain 60 fps cap
+                window.setVerticalSyncEnabled(false);
+                window.setFramerateLimit(60);
+                if (recordGame) {
+                    recording.finish(game);
+                    if (!saveReplay(recordPath, recording)) {
+                        cerr << "Error: Could not write replay " << recordPath << endl;
+                    }
+                }
+                scores.submit(currentLevel, game.score, game.seed, game.tick);
+                if (game.score > highScores[currentLevelIndex]) {
+                    highScores[currentLevelIndex] = game.score;
+                }
+                cout << "Draw calls per frame: " << renderStats.averageDrawCalls() << " avg, " << renderStats.maxDrawCalls << " max" << endl;
+                if (scaledPlayfield) {
+                    cout << "Playfield resolution: " << resolution.scale() * 100 << "% now, " << resolution.lowestScale() * 100 << "% lowest, "
+                         << resolution.changes() << " changes, " << resolution.averageMillis() << " ms avg frame (budget "
+                         << resolution.budget() << " ms)" << endl;
+                }
+                cout << "Particles: " << particles.peak() << " peak, " << particles.dropped() << " dropped, limit " << particles.limit()
+                     << " of " << particles.capacity() << endl;
+                cout << "Taps shorter than a frame: " << input.shortTaps() << endl;
+                cout << "HUD rebuilds: " << hud.totalRebuilds() << " total, " << hud.rebuildsPerSecond() << " in the last second" << endl;
+                if (allocCountingEnabled()) {
+                    cout << "Frames allocating after warm-up: " << frameAllocs.flaggedFrames() << " of " << frameAllocs.frames() << endl;
+                }
+                Text scoreText("Your Score: " + to_string(game.score), font, 60);
+                scoreText.setFillColor(Color::White);
+                scoreText.setPosition(100, 10);
+                Text highScoreText("Highest Score: " + to_string(highScores[currentLevelIndex]), font, 60);
+                highScoreText.setFillColor(Color::White);
+                highScoreText.setPosition(1300, 10);
+
+                if (soundEnabled) {
+                    audio.trigger(SFX_GAME_OVER);
+                    backgroundMusic.stop();
+                }
+                window.clear();
+                gameOverSprite.setPosition(700, 350);
+                window.draw(gameOverSprite);
+                window.draw(scoreText);
+                window.draw(highScoreText);
+                window.display();
+
+                bool waitingForInput = true;
+                while (waitingForInput && window.isOpen()) {
+                    input.wait(window);
+                    for (const InputEvent& event : input.events()) {
+                        if (event.pressed && !event.repeat) {
+                            waitingForInput = false;
+                        }
+                    }
+                    if (!waitingForInput) {
+                        playAgain = true;
+
+                        currentLevel = displayDifficultyPage(window, font, resources, audio, input);
+                        currentLevelIndex = static_cast<int>(currentLevel);
+
+                        // Reset the game variables (e.g., hearts, player position, etc.)
+                        config.level = currentLevel;
+                        config.alienSpeed = levelAlienSpeed(currentLevel);
+                        resetGame(game, config, nextSeed++);
+                        recordGame = !recordPath.empty();
+                        recording.begin(game);
+                        sim.start(nullptr, recordGame ? &recording : nullptr);
+                        shotsHeard = 0;
+                        heartsHeard = 0;
+                        fill(begin(pressesSeen), end(pressesSeen), 0u);
+                        particles.clear();
+                        window.setFramerateLimit(0);
+                        window.setVerticalSyncEnabled(true);
+                        if (soundEnabled) {
+                            backgroundMusic.play();
+                        }
+                    }
+                }
+            }
+
+        }
+    }
+    profiler.writeCsv("profile.csv");
+    simProfiler.writeCsv("profile_sim.csv");
+    resources.printReport(cout);
+    audio.printReport(cout);
+    input.latency().printReport(cout);
+    return 0;
+}
+
+// Function to display the difficulty level selection page
+Level displayDifficultyPage(RenderWindow& window, Font& font, ResourceCache& resources, AudioSystem& audio, InputSystem& input) {
+    Texture* difficultyTexture = resources.texture("texture/main page.jpg");
+    Sprite difficultyPage;
+    if (difficultyTexture) {
+        difficultyPage.setTexture(*difficultyTexture);
+    }
+    else {
+        cerr << "Error: Could not load difficulty background texture!" << endl;
+    }
+    difficultyPage.setScale(
+        static_cast<float>(WINDOW_WIDTH) / difficultyPage.getLocalBounds().width,
+        static_cast<float>(WINDOW_HEIGHT) / difficultyPage.getLocalBounds().height
+    );
+
+    Text easyText("EASY", font, 90);
+    easyText.setPosition(880, 700);
+    easyText.setFillColor(Color::Red);
+
+    Text mediumText("MEDIUM", font, 90);
+    mediumText.setPosition(830, 800);
+    mediumText.setFillColor(Color::White);
+
+    Text hardText("HARD", font, 90);
+    hardText.setPosition(880, 900);
+    hardText.setFillColor(Color::White);
+
+    Text endText("Click BackSpace to return to main page.", font, 40);
+    endText.setPosition(585, 1000);
+    endText.setFillColor(Color::Black);
+
+    MenuBackdrop backdrop;
+    backdrop.compose(difficultyPage, { &endText });
+
+    Level selectedLevel = Level::EASY;
+    bool selecting = true;
+    bool redraw = true;
+
+    while (selecting && window.isOpen()) {
+        // Render difficulty page, only when something on it changed
+        if (redraw) {
+            easyText.setFillColor(selectedLevel == Level::EASY ? Color::Red : Color::White);
+            mediumText.setFillColor(selectedLevel == Level::MEDIUM ? Color::Red : Color::White);
+            hardText.setFillColor(selectedLevel == Level::HARD ? Color::Red : Color::White);
+
+            window.clear();
+            backdrop.draw(window);
+            window.draw(easyText);
+            window.draw(mediumText);
+            window.draw(hardText);
+            window.display();
+            input.presented();
+            redraw = false;
+        }
+
+        // Sleep until a key arrives
+        input.wait(window);
+        Level previousLevel = selectedLevel;
+        bool backToHome = false;
+        for (const InputEvent& event : input.events()) {
+            if (event.pressed) {
+                if (event.action == ACTION_QUIT) {
+                    window.close();
+                }
+                if (event.action == ACTION_BACK) {
+                    backToHome = true;
+                }
+
+                if (event.action == ACTION_UP) {
+                    if (selectedLevel == Level::MEDIUM) {
+                        selectedLevel = Level::EASY;
+                        audio.trigger(SFX_NAVIGATION);
+                    }
+                    else if (selectedLevel == Level::HARD) {
+                        selectedLevel = Level::MEDIUM;
+                        audio.trigger(SFX_NAVIGATION);
+                    }
+                }
+
+                if (event.action == ACTION_DOWN) {
+                    if (selectedLevel == Level::EASY) {
+                        selectedLevel = Level::MEDIUM;
+                        audio.trigger(SFX_NAVIGATION);
+                    }
+                    else if (selectedLevel == Level::MEDIUM) {
+                        selectedLevel = Level::HARD;
+                        audio.trigger(SFX_NAVIGATION);
+                    }
+                }
+
+                if (event.action == ACTION_CONFIRM) {
+                    selecting = false;
+                }
+            }
+        }
+        //The home page polls on its own, so it is only entered once this batch is handled
+        if (backToHome) {
+            displayHomePage(window, font, resources, audio, input);
+            redraw = true;
+            continue;
+        }
+        redraw = selectedLevel != previousLevel || input.exposed();
+    }
+    return selectedLevel;
+}
+
+// Function to display the home page with buttons
+void displayHomePage(RenderWindow& window, Font& font, ResourceCache& resources, AudioSystem& audio, InputSystem& input) {
+    Texture* homeTexture = resources.texture("texture/main page.jpg");
+    Sprite homePage;
+    if (homeTexture) {
+        homePage.setTexture(*homeTexture);
+    }
+    else {
+        cerr << "Error: Could not load background texture!" << endl;
+    }
+    homePage.setScale(
+        static_cast<float>(WINDOW_WIDTH) / homePage.getLocalBounds().width,
+        static_cast<float>(WINDOW_HEIGHT) / homePage.getLocalBounds().height
+    );
+
+    Text startText("START", font, 70);
+    startText.setPosition(880, 750);
+    startText.setFillColor(Color::Red);
+
+    Text optionsText("OPTIONS", font, 70);
+    optionsText.setPosition(850, 850);
+    optionsText.setFillColor(Color::White);
+
+    Text exitText("EXIT", font, 70);
+    exitText.setPosition(900, 950);
+    exitText.setFillColor(Color::White);
+
+    // Progress of the background asset loading
+    const float LOADING_BAR_WIDTH = 600;
+    RectangleShape loadingBarBack(Vector2f(LOADING_BAR_WIDTH, 8));
+    loadingBarBack.setPosition((WINDOW_WIDTH - LOADING_BAR_WIDTH) / 2, WINDOW_HEIGHT - 40);
+    loadingBarBack.setFillColor(Color(255, 255, 255, 60));
+    RectangleShape loadingBar;
+    loadingBar.setPosition(loadingBarBack.getPosition());
+    loadingBar.setFillColor(Color::Red);
+
+    MenuBackdrop backdrop;
+    backdrop.compose(homePage);
+
+    int selectedOption = 0;
+    bool selectingMain = true;
+    bool redraw = true;
+    float shownProgress = -1;
+
+    while (selectingMain && window.isOpen()) {
+        // Upload a couple of finished background loads per frame
+        bool wasPreloading = resources.preloading();
+        resources.pump();
+        if (wasPreloading && !resources.preloading()) {
+            resources.printStartupReport(cout);
+            redraw = true;
+        }
+        if (resources.preloading() && resources.progress() != shownProgress) {
+            redraw = true;
+        }
+
+        // Render home page, only when something on it changed
+        if (redraw) {
+            startText.setFillColor(selectedOption == 0 ? Color::Red : Color::White);
+            optionsText.setFillColor(selectedOption == 1 ? Color::Red : Color::White);
+            exitText.setFillColor(selectedOption == 2 ? Color::Red : Color::White);
+
+            window.clear();
+            backdrop.draw(window);
+            window.draw(startText);
+            window.draw(optionsText);
+            window.draw(exitText);
+            if (resources.preloading()) {
+                shownProgress = resources.progress();
+                loadingBar.setSize(Vector2f(LOADING_BAR_WIDTH * shownProgress, 8));
+                window.draw(loadingBarBack);
+                window.draw(loadingBar);
+            }
+            window.display();
+            input.presented();
+            resources.markInteractive();
+            redraw = false;
+        }
+
+        // Wake every frame while assets are loading, otherwise sleep until a key arrives
+        input.wait(window, resources.preloading() ? milliseconds(16) : Time::Zero);
+        int previousOption = selectedOption;
+        bool openOptions = false;
+        for (const InputEvent& event : input.events()) {
+            if (event.pressed) {
+                if (event.action == ACTION_QUIT) {
+                    window.close();
+                }
+                if (event.action == ACTION_UP) {
+                    selectedOption = (selectedOption - 1 + 3) % 3;
+                    audio.trigger(SFX_NAVIGATION);
+                }
+                if (event.action == ACTION_DOWN) {
+                    selectedOption = (selectedOption + 1) % 3;
+                    audio.trigger(SFX_NAVIGATION);
+                }
+                if (event.action == ACTION_CONFIRM) {
+                    switch (selectedOption) {
+                    case 0:
+                        audio.trigger(SFX_SELECTION);
+                        selectingMain = false;
+                        break;
+                    case 1:
+                        audio.trigger(SFX_SELECTION);
+                        openOptions = true;
+                        break;
+                    case 2:
+                        audio.trigger(SFX_SELECTION);
+                        window.close();
+                        break;
+                    }
+                }
+            }
+        }
+        if (openOptions) {
+            displayOptionsMenu(window, font, resources, audio, input, soundEnabled);
+            redraw = true;
+            continue;
+        }
+        if (selectedOption != previousOption || input.exposed()) {
+            redraw = true;
+        }
+    }
+}
+
+// Function to display option menu
+void displayOptionsMenu(RenderWindow& window, Font& font, ResourceCache& resources, AudioSystem& audio, InputSystem& input, bool& soundEnabled) {
+    Texture* optionsTexture = resources.texture("texture/main page.jpg");
+    Sprite optionsPage;
+    if (optionsTexture) {
+        optionsPage.setTexture(*optionsTexture);
+    }
+    else {
+        cerr << "Error: Could not load options background texture!" << endl;
+    }
+    optionsPage.setScale(
+        static_cast<float>(WINDOW_WIDTH) / optionsPage.getLocalBounds().width,
+        static_cast<float>(WINDOW_HEIGHT) / optionsPage.getLocalBounds().height
+    );
+
+    Text soundText("SOUND: " + string(soundEnabled ? "ON" : "OFF"), font, 70);
+    soundText.setPosition(800, 750);
+    soundText.setFillColor(Color::Red);
+
+    Text backText("BACK", font, 70);
+    backText.setPosition(880, 850);
+    backText.setFillColor(Color::White);
+
+
+    MenuBackdrop backdrop;
+    backdrop.compose(optionsPage);
+
+    bool selecting = true;
+    bool redraw = true;
+    while (selecting && window.isOpen()) {
+        if (redraw) {
+            window.clear();
+            backdrop.draw(window);
+            window.draw(soundText);
+            window.draw(backText);
+            window.display();
+            input.presented();
+            redraw = false;
+        }
+
+        // Sleep until a key arrives
+        input.wait(window);
+        redraw = input.exposed();
+        for (const InputEvent& event : input.events()) {
+            if (event.pressed) {
+                if (event.action == ACTION_UP || event.action == ACTION_DOWN) {
+                    redraw = true;
+                    if (soundText.getFillColor() == Color::Red) {
+                        soundText.setFillColor(Color::White);
+                        backText.setFillColor(Color::Red);
+                        audio.trigger(SFX_NAVIGATION);
+                    }
+                    else {
+                        soundText.setFillColor(Color::Red);
+                        backText.setFillColor(Color::White);
+                        audio.trigger(SFX_NAVIGATION);
+                    }
+                }
+                if (event.action == ACTION_CONFIRM) {
+                    if (soundText.getFillColor() == Color::Red) {
+                        soundEnabled = !soundEnabled;
+                        soundText.setString("SOUND: " + string(soundEnabled ? "ON" : "OFF"));
+                        audio.trigger(SFX_SELECTION);
+                        redraw = true;
+                    }
+                    else if (backText.getFillColor() == Color::Red) {
+                        selecting = false;
+                        audio.trigger(SFX_SELECTION);
+                    }
+                }
+                if (event.action == ACTION_QUIT) {
+                    selecting = false;
+                }
+            }
+        }
+    }
+}
+
+//Function to carry the best scores of the old text file over to the score store
+void importHighScores(ScoreStore& scores) {
+    ifstream inFile(HIGH_SCORE_FILE);
+    if (!inFile.is_open()) {
+        return;
+    }
+    int highScores[3] = { 0, 0, 0 };
+    string line;
+    while (getline(inFile, line)) {
+        if (line.find("Easy:") == 0) {
+            highScores[0] = stoi(line.substr(5));
+        }
+        else if (line.find("Medium:") == 0) {
+            highScores[1] = stoi(line.substr(7));
+        }
+        else if (line.find("Hard:") == 0) {
+            highScores[2] = stoi(line.substr(5));
+        }
+    }
+    inFile.close();
+    for (int i = 0; i < 3; i++) {
+        if (highScores[i] > 0) {
+            scores.submit(Level(i), highScores[i], 0, 0);
+        }
+    }
+    scores.flush();
+}
+
+//Function to build a sprite's collision mask at the size it is drawn (a texture read-back, so load time only)
+CollisionMask spriteMask(const Sprite& sprite) {
+    Image image = sprite.getTexture()->copyToImage();
+    FloatRect bounds = sprite.getGlobalBounds();
+    return buildMask(image.getPixelsPtr(), image.getSize().x, image.getSize().y,
+                     static_cast<int>(lround(bounds.width)), static_cast<int>(lround(bounds.height)));
+}
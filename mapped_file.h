@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+// Read-only memory mapping of a whole file (mmap on POSIX, a file mapping
+// view on Windows). An empty file opens fine with size() == 0.
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    //Exchanges mappings, e.g. to put a freshly opened file in place under a lock
+    void swap(MappedFile& other);
+
+    bool isOpen() const { return opened; }
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const unsigned char* bytes = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+// Durable writes for files that have to survive a crash: write a temporary
+// file, syncFile() it, then replaceFile() it over the real one.
+
+//Pushes a file's written data all the way to the disk
+bool syncFile(FILE* file);
+//Renames over the target, then syncs the directory so the rename is durable too
+bool replaceFile(const std::string& from, const std::string& to);
@@ -0,0 +1,104 @@
+#include "mask.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+bool CollisionMask::test(int x, int y) const {
+    if (x < 0 || y < 0 || x >= width || y >= height) {
+        return false;
+    }
+    return (bits[static_cast<size_t>(y) * words + x / 64] >> (x % 64)) & 1;
+}
+
+CollisionMask buildMask(const unsigned char* rgba, unsigned imageWidth, unsigned imageHeight, int width, int height, unsigned char threshold) {
+    CollisionMask mask;
+    if (!rgba || imageWidth == 0 || imageHeight == 0 || width <= 0 || height <= 0) {
+        return mask;
+    }
+    mask.width = width;
+    mask.height = height;
+    mask.words = (width + 63) / 64;
+    mask.bits.assign(static_cast<size_t>(mask.words) * height, 0);
+    for (int y = 0; y < height; y++) {
+        unsigned sy0 = static_cast<unsigned>(static_cast<unsigned long long>(y) * imageHeight / height);
+        unsigned sy1 = max(sy0 + 1, static_cast<unsigned>(static_cast<unsigned long long>(y + 1) * imageHeight / height));
+        for (int x = 0; x < width; x++) {
+            unsigned sx0 = static_cast<unsigned>(static_cast<unsigned long long>(x) * imageWidth / width);
+            unsigned sx1 = max(sx0 + 1, static_cast<unsigned>(static_cast<unsigned long long>(x + 1) * imageWidth / width));
+            unsigned long long sum = 0;
+            for (unsigned sy = sy0; sy < sy1; sy++) {
+                for (unsigned sx = sx0; sx < sx1; sx++) {
+                    sum += rgba[(static_cast<size_t>(sy) * imageWidth + sx) * 4 + 3];
+                }
+            }
+            if (sum >= static_cast<unsigned long long>(threshold) * (sy1 - sy0) * (sx1 - sx0)) {
+                mask.bits[static_cast<size_t>(y) * mask.words + x / 64] |= 1ull << (x % 64);
+            }
+        }
+    }
+    return mask;
+}
+
+bool masksOverlap(const CollisionMask& a, float ax, float ay, const CollisionMask& b, float bx, float by) {
+    long dx = lround(bx - ax);
+    long dy = lround(by - ay);
+    //Shift whichever mask lies further right into the other's frame
+    const CollisionMask* left = &a;
+    const CollisionMask* right = &b;
+    if (dx < 0) {
+        swap(left, right);
+        dx = -dx;
+        dy = -dy;
+    }
+    if (dx >= left->width) {
+        return false;
+    }
+    long y0 = max(0L, dy);
+    long y1 = min(static_cast<long>(left->height), dy + right->height);
+    long shift = dx % 64;
+    for (long y = y0; y < y1; y++) {
+        const unsigned long long* leftRow = &left->bits[static_cast<size_t>(y) * left->words];
+        const unsigned long long* rightRow = &right->bits[static_cast<size_t>(y - dy) * right->words];
+        for (long word = 0; word < right->words; word++) {
+            long index = dx / 64 + word;
+            if (index >= left->words) {
+                break;
+            }
+            //The 64 pixels of the left row that sit under this word of the right row
+            unsigned long long under = leftRow[index] >> shift;
+            if (shift && index + 1 < left->words) {
+                under |= leftRow[index + 1] << (64 - shift);
+            }
+            if (under & rightRow[word]) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool maskOverlapsBox(const CollisionMask& mask, float x, float y, const Aabb& box) {
+    int x0 = max(0, static_cast<int>(floor(box.x - x)));
+    int x1 = min(mask.width, static_cast<int>(ceil(box.x + box.w - x)));
+    int y0 = max(0, static_cast<int>(floor(box.y - y)));
+    int y1 = min(mask.height, static_cast<int>(ceil(box.y + box.h - y)));
+    if (x0 >= x1 || y0 >= y1) {
+        return false;
+    }
+    int firstWord = x0 / 64;
+    int lastWord = (x1 - 1) / 64;
+    for (int row = y0; row < y1; row++) {
+        const unsigned long long* bits = &mask.bits[static_cast<size_t>(row) * mask.words];
+        for (int word = firstWord; word <= lastWord; word++) {
+            //Columns [x0, x1) that fall in this word
+            unsigned long long span = ~0ull;
+            if (word == firstWord) span &= ~0ull << (x0 % 64);
+            if (word == lastWord && x1 % 64) span &= ~0ull >> (64 - x1 % 64);
+            if (bits[word] & span) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include "simd.h"
+
+// One-bit-per-pixel collision masks at the size a sprite is drawn, built
+// once from the texture's alpha. Each row is padded to whole 64-bit words
+// (bits past the width are zero), so the narrow phase compares 64 pixels
+// per AND: a row of one mask is shifted into the other's frame a word at a
+// time. Masks are placed at the entity's top-left corner, rounded to whole
+// pixels, and only run after the boxes already overlap.
+
+struct CollisionMask {
+    int width = 0, height = 0;
+    int words = 0;                          // 64-bit words per row
+    std::vector<unsigned long long> bits;   // bit x of row y: bits[y * words + x / 64] >> (x % 64)
+
+    bool empty() const { return width == 0 || height == 0; }
+    bool test(int x, int y) const;
+};
+
+//Box-filters the alpha of an RGBA8 image down (or up) to width x height; a
+//pixel is solid when its average alpha reaches the threshold
+CollisionMask buildMask(const unsigned char* rgba, unsigned imageWidth, unsigned imageHeight, int width, int height,
+                        unsigned char threshold = 128);
+
+//True if any solid pixel of a at (ax, ay) meets a solid pixel of b at (bx, by)
+bool masksOverlap(const CollisionMask& a, float ax, float ay, const CollisionMask& b, float bx, float by);
+//True if any solid pixel of the mask at (x, y) lies inside the box
+bool maskOverlapsBox(const CollisionMask& mask, float x, float y, const Aabb& box);
+
+//Masks of the three sprites that collide; empty masks mean plain AABB hits
+struct CollisionMasks {
+    CollisionMask player, alien, heart;
+
+    bool empty() const { return player.empty() || alien.empty() || heart.empty(); }
+};
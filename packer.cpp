@@ -0,0 +1,110 @@
+// Offline asset packer: decodes the loose files in texture/ once and writes
+// them into a single archive the game memory-maps at startup (see
+// asset_pack.h). Images become RGBA8, sound effects 16-bit PCM, and fonts
+// are copied as they are. Files given with --raw are copied as they are too;
+// use it for music, which is streamed and would be many times larger as PCM.
+//
+// Build: g++ -std=c++17 -O2 packer.cpp asset_pack.cpp mapped_file.cpp -lsfml-graphics -lsfml-audio -lsfml-system -o packer
+// Usage: packer [-o texture/assets.pack] [--raw file]... file...
+// For this game:
+//        packer --raw "texture/background sound.mp3" "texture/main page.jpg" "texture/back ground.jpg"
+//               texture/sprite.png texture/alien.png texture/heart1.png texture/over.png texture/font3.ttf
+//               texture/navigation.mp3 texture/selection.mp3 texture/bullets.mp3 texture/gameover.mp3 "texture/hrt pick.mp3"
+// Names are stored exactly as given, so pass the paths the game loads them by.
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "asset_pack.h"
+
+using namespace std;
+
+static string extension(const string& path) {
+    size_t dot = path.find_last_of('.');
+    return dot == string::npos ? "" : path.substr(dot + 1);
+}
+
+static bool isImage(const string& ext) {
+    return ext == "png" || ext == "jpg" || ext == "jpeg" || ext == "bmp" || ext == "tga";
+}
+
+static bool isSound(const string& ext) {
+    return ext == "wav" || ext == "ogg" || ext == "flac" || ext == "mp3";
+}
+
+static bool readFile(const string& path, vector<unsigned char>& bytes) {
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    bytes.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    return true;
+}
+
+static bool packFile(AssetPackWriter& writer, const string& path, bool raw, const char*& kind) {
+    string ext = extension(path);
+    if (!raw && isImage(ext)) {
+        kind = "image";
+        sf::Image image;
+        if (!image.loadFromFile(path)) {
+            return false;
+        }
+        return writer.addImage(path, image.getSize().x, image.getSize().y, image.getPixelsPtr());
+    }
+    if (!raw && isSound(ext)) {
+        kind = "sound";
+        sf::InputSoundFile file;
+        if (!file.openFromFile(path)) {
+            return false;
+        }
+        vector<sf::Int16> samples(static_cast<size_t>(file.getSampleCount()));
+        samples.resize(static_cast<size_t>(file.read(samples.data(), samples.size())));
+        return writer.addSound(path, file.getChannelCount(), file.getSampleRate(), samples.data(), samples.size());
+    }
+    kind = "raw";
+    vector<unsigned char> bytes;
+    return readFile(path, bytes) && writer.addRaw(path, bytes.data(), bytes.size());
+}
+
+int main(int argc, char* argv[]) {
+    string outPath = "texture/assets.pack";
+    vector<pair<string, bool>> inputs;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            outPath = argv[++i];
+        }
+        else if (arg == "--raw" && i + 1 < argc) {
+            inputs.emplace_back(argv[++i], true);
+        }
+        else {
+            inputs.emplace_back(arg, false);
+        }
+    }
+    if (inputs.empty()) {
+        cerr << "Usage: packer [-o out.pack] [--raw file]... file..." << endl;
+        return 1;
+    }
+
+    AssetPackWriter writer;
+    for (const auto& input : inputs) {
+        auto start = chrono::steady_clock::now();
+        const char* kind = "";
+        if (!packFile(writer, input.first, input.second, kind)) {
+            cerr << "Error: Could not pack " << input.first << endl;
+            return 1;
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "  " << kind << "\t" << input.first << "  (" << ms << " ms)" << endl;
+    }
+    if (!writer.write(outPath)) {
+        return 1;
+    }
+    cout << "Wrote " << outPath << ": " << inputs.size() << " entries, " << writer.dataBytes() << " bytes of data" << endl;
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "particles.h"
+#include <algorithm>
+#include <cmath>
+#include "simd.h"
+
+using namespace std;
+
+const float PARTICLE_DRAG = 2.5f;
+const float PARTICLE_GRAVITY = 600.0f;
+//The limit never drops below this, so hits always show something
+const size_t MIN_PARTICLE_LIMIT = 1024;
+
+const ParticleStyle& effectStyle(EffectKind kind) {
+    static const ParticleStyle shot = { 6, 60.0f, 180.0f, 0.15f, 3.0f, 0x7CFF7CFFu };
+    static const ParticleStyle alien = { 48, 120.0f, 520.0f, 0.7f, 4.0f, 0xFFA030FFu };
+    static const ParticleStyle hit = { 64, 160.0f, 640.0f, 0.9f, 5.0f, 0xFF3030FFu };
+    static const ParticleStyle heart = { 32, 80.0f, 320.0f, 0.8f, 4.0f, 0xFF70B0FFu };
+    switch (kind) {
+    case EFFECT_SHOT: return shot;
+    case EFFECT_ALIEN_DESTROYED: return alien;
+    case EFFECT_PLAYER_HIT: return hit;
+    default: return heart;
+    }
+}
+
+ParticleSystem::ParticleSystem(size_t capacity, float budgetMillis)
+    : cap(capacity), liveLimit(capacity), budgetMillis(budgetMillis),
+      x(new float[capacity]), y(new float[capacity]), vx(new float[capacity]), vy(new float[capacity]),
+      life(new float[capacity]), invLife(new float[capacity]), side(new float[capacity]), color(new unsigned[capacity]) {
+    rng.seed(0x5EED);
+}
+
+void ParticleSystem::burst(float px, float py, const ParticleStyle& style) {
+    size_t room = liveLimit > count ? liveLimit - count : 0;
+    size_t n = min(style.count, room);
+    droppedCount += style.count - n;
+    const float TWO_PI = 6.2831853f;
+    for (size_t k = 0; k < n; k++) {
+        size_t i = count++;
+        //Uniform in [0, 1) from the top 24 bits, then scaled
+        float angle = (rng.next() >> 8) * (TWO_PI / 16777216.0f);
+        float speed = style.minSpeed + (rng.next() >> 8) * ((style.maxSpeed - style.minSpeed) / 16777216.0f);
+        float span = style.life * (0.6f + (rng.next() >> 8) * (0.4f / 16777216.0f));
+        x[i] = px;
+        y[i] = py;
+        vx[i] = cos(angle) * speed;
+        vy[i] = sin(angle) * speed;
+        life[i] = span;
+        invLife[i] = 1.0f / span;
+        side[i] = style.size;
+        color[i] = style.color;
+    }
+    peakCount = max(peakCount, count);
+}
+
+void ParticleSystem::update(float dt) {
+    if (count == 0) {
+        return;
+    }
+    simdKernels().integrate(x.get(), y.get(), vx.get(), vy.get(), count, dt);
+
+    float damp = max(0.0f, 1.0f - PARTICLE_DRAG * dt);
+    float fall = PARTICLE_GRAVITY * dt;
+    float* velX = vx.get();
+    float* velY = vy.get();
+    float* left = life.get();
+    for (size_t i = 0; i < count; i++) {
+        velX[i] *= damp;
+        velY[i] = velY[i] * damp + fall;
+        left[i] -= dt;
+    }
+
+    //Swap-and-pop the expired; order does not matter for drawing
+    size_t i = 0;
+    while (i < count) {
+        if (left[i] > 0) {
+            i++;
+            continue;
+        }
+        size_t last = --count;
+        x[i] = x[last];
+        y[i] = y[last];
+        velX[i] = velX[last];
+        velY[i] = velY[last];
+        left[i] = left[last];
+        invLife[i] = invLife[last];
+        side[i] = side[last];
+        color[i] = color[last];
+    }
+}
+
+void ParticleSystem::adapt(float frameMillis) {
+    if (frameMillis > budgetMillis) {
+        //Cut straight to what fit in the budget, then a bit more
+        size_t fit = static_cast<size_t>(count * (budgetMillis / frameMillis) * 0.9f);
+        liveLimit = max(MIN_PARTICLE_LIMIT, min(liveLimit, fit));
+    }
+    else if (frameMillis < budgetMillis * 0.5f) {
+        liveLimit = min(cap, liveLimit + cap / 64);
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include "game.h"
+
+// Visual-only particles for shots, alien kills, player hits and heart
+// pickups. Nothing here feeds back into the simulation, so particles use
+// their own RNG and real frame time and never touch replays.
+//
+// Storage is struct-of-arrays in fixed-capacity arrays allocated once, so
+// emitting never allocates. update() moves every live particle with the
+// SIMD integrate kernel, applies drag and gravity in one vectorizable loop,
+// and swap-removes the expired ones. New particles are dropped (and
+// counted) past the current limit. adapt() lowers that limit whenever the
+// measured particle cost of a frame goes over its budget and raises it
+// again slowly once there is room, so effects can never take the frame
+// rate with them.
+
+const size_t PARTICLE_CAPACITY = 131072;
+const float PARTICLE_BUDGET_MS = 2.0f;
+
+//Colours are packed 0xRRGGBBAA so this header stays free of SFML
+struct ParticleStyle {
+    size_t count;
+    float minSpeed, maxSpeed;
+    float life;
+    float size;
+    unsigned color;
+};
+
+const ParticleStyle& effectStyle(EffectKind kind);
+
+class ParticleSystem {
+public:
+    explicit ParticleSystem(size_t capacity = PARTICLE_CAPACITY, float budgetMillis = PARTICLE_BUDGET_MS);
+
+    void emit(const GameEffect& effect) { burst(effect.x, effect.y, effectStyle(effect.kind)); }
+    //style.count particles from (x, y) in random directions
+    void burst(float x, float y, const ParticleStyle& style);
+    void update(float dt);
+    void clear() { count = 0; }
+    //Feeds one frame's particle cost (update plus batching) into the limit
+    void adapt(float frameMillis);
+
+    size_t size() const { return count; }
+    size_t capacity() const { return cap; }
+    size_t limit() const { return liveLimit; }
+    size_t peak() const { return peakCount; }
+    unsigned long long dropped() const { return droppedCount; }
+
+    //Dense arrays for the renderer, size() long
+    const float* xs() const { return x.get(); }
+    const float* ys() const { return y.get(); }
+    const float* sizes() const { return side.get(); }
+    const unsigned* colors() const { return color.get(); }
+    //1 when born, 0 when expired
+    float fade(size_t i) const { return life[i] * invLife[i]; }
+
+private:
+    size_t cap;
+    size_t count = 0;
+    size_t liveLimit;
+    size_t peakCount = 0;
+    unsigned long long droppedCount = 0;
+    float budgetMillis;
+    GameRng rng;
+
+    std::unique_ptr<float[]> x, y, vx, vy;
+    std::unique_ptr<float[]> life, invLife, side;
+    std::unique_ptr<unsigned[]> color;
+};
@@ -0,0 +1,97 @@
+#include "profiler.h"
+#include <algorithm>
+#include <fstream>
+
+using namespace std;
+
+const char* phaseName(ProfilePhase phase) {
+    switch (phase) {
+    case PHASE_EVENTS: return "events";
+    case PHASE_INPUT: return "input";
+    case PHASE_SPAWN: return "spawn";
+    case PHASE_MOVE_BULLETS: return "move_bullets";
+    case PHASE_MOVE_ALIENS: return "move_aliens";
+    case PHASE_MOVE_HEARTS: return "move_hearts";
+    case PHASE_COMPACT: return "compact";
+    case PHASE_BROADPHASE: return "broadphase";
+    case PHASE_COLLIDE_BULLETS: return "collide_bullets";
+    case PHASE_COLLIDE_PLAYER: return "collide_player";
+    case PHASE_COLLIDE_HEARTS: return "collide_hearts";
+    case PHASE_PARTICLES: return "particles";
+    case PHASE_RENDER: return "render";
+    case PHASE_DISPLAY: return "display";
+    default: return "unknown";
+    }
+}
+
+Profiler::Profiler(size_t capacity) : ring(max<size_t>(capacity, 1)) {
+}
+
+void Profiler::beginFrame() {
+    current = FrameSample();
+    current.frame = head.load(memory_order_relaxed);
+}
+
+void Profiler::endFrame() {
+    unsigned long long index = head.load(memory_order_relaxed);
+    ring[index % ring.size()] = current;
+    head.store(index + 1, memory_order_release);
+}
+
+size_t Profiler::frameCount() const {
+    return static_cast<size_t>(min<unsigned long long>(head.load(memory_order_acquire), ring.size()));
+}
+
+void Profiler::recent(size_t count, vector<FrameSample>& out) const {
+    unsigned long long end = head.load(memory_order_acquire);
+    count = min(count, static_cast<size_t>(min<unsigned long long>(end, ring.size())));
+    out.clear();
+    for (unsigned long long i = end - count; i < end; i++) {
+        out.push_back(ring[i % ring.size()]);
+    }
+}
+
+PhaseStats Profiler::stats(ProfilePhase phase, size_t frames) const {
+    vector<FrameSample> samples;
+    recent(frames, samples);
+    PhaseStats result;
+    if (samples.empty()) {
+        return result;
+    }
+
+    vector<float> values;
+    values.reserve(samples.size());
+    double sum = 0;
+    for (const auto& sample : samples) {
+        values.push_back(sample.micros[phase]);
+        sum += sample.micros[phase];
+    }
+    sort(values.begin(), values.end());
+    result.average = sum / values.size();
+    result.p99 = values[min(values.size() - 1, static_cast<size_t>(values.size() * 0.99))];
+    result.max = values.back();
+    return result;
+}
+
+bool Profiler::writeCsv(const string& path) const {
+    ofstream outFile(path);
+    if (!outFile.is_open()) {
+        return false;
+    }
+    outFile << "frame";
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        outFile << "," << phaseName(static_cast<ProfilePhase>(phase)) << "_us";
+    }
+    outFile << endl;
+
+    vector<FrameSample> samples;
+    recent(ring.size(), samples);
+    for (const auto& sample : samples) {
+        outFile << sample.frame;
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            outFile << "," << sample.micros[phase];
+        }
+        outFile << "\n";
+    }
+    return true;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// Per-phase frame timings. Each frame accumulates microseconds per phase
+// and is then published into a fixed ring buffer. There is one writer, and
+// readers only see slots published through the atomic head, so nothing
+// locks. Old frames are overwritten once the ring wraps.
+
+enum ProfilePhase {
+    PHASE_EVENTS,
+    PHASE_INPUT,
+    PHASE_SPAWN,
+    PHASE_MOVE_BULLETS,
+    PHASE_MOVE_ALIENS,
+    PHASE_MOVE_HEARTS,
+    PHASE_COMPACT,
+    PHASE_BROADPHASE,
+    PHASE_COLLIDE_BULLETS,
+    PHASE_COLLIDE_PLAYER,
+    PHASE_COLLIDE_HEARTS,
+    PHASE_PARTICLES,
+    PHASE_RENDER,
+    PHASE_DISPLAY,
+    PHASE_COUNT
+};
+
+const char* phaseName(ProfilePhase phase);
+
+struct FrameSample {
+    unsigned long long frame = 0;
+    float micros[PHASE_COUNT] = {};
+};
+
+struct PhaseStats {
+    double average = 0;
+    double p99 = 0;
+    double max = 0;
+};
+
+class Profiler {
+public:
+    explicit Profiler(size_t capacity = 4096);
+
+    void beginFrame();
+    void add(ProfilePhase phase, float micros) { current.micros[phase] += micros; }
+    void endFrame();
+
+    size_t frameCount() const;
+    //Copies the newest frames (up to count), oldest first
+    void recent(size_t count, std::vector<FrameSample>& out) const;
+    PhaseStats stats(ProfilePhase phase, size_t frames) const;
+    bool writeCsv(const std::string& path) const;
+
+private:
+    std::vector<FrameSample> ring;
+    std::atomic<unsigned long long> head{ 0 };
+    FrameSample current;
+};
+
+//Adds the lifetime of the scope to one phase; a null profiler is a no-op
+class ProfileScope {
+public:
+    ProfileScope(Profiler* profiler, ProfilePhase phase) : profiler(profiler), phase(phase) {
+        if (profiler) start = std::chrono::steady_clock::now();
+    }
+    ~ProfileScope() {
+        if (profiler) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            profiler->add(phase, std::chrono::duration<float, std::micro>(elapsed).count());
+        }
+    }
+
+private:
+    Profiler* profiler;
+    ProfilePhase phase;
+    std::chrono::steady_clock::time_point start;
+};
@@ -0,0 +1,97 @@
+#include "render.h"
+#include <algorithm>
+
+using namespace sf;
+using namespace std;
+
+void RenderStats::beginFrame() {
+    drawCalls = 0;
+    quads = 0;
+}
+
+void RenderStats::endFrame() {
+    frames++;
+    totalDrawCalls += drawCalls;
+    maxDrawCalls = max(maxDrawCalls, drawCalls);
+}
+
+double RenderStats::averageDrawCalls() const {
+    return frames > 0 ? static_cast<double>(totalDrawCalls) / frames : 0.0;
+}
+
+SpriteBatch::SpriteBatch(const Texture* texture) : vertices(Quads) {
+    setTexture(texture);
+}
+
+void SpriteBatch::setTexture(const Texture* newTexture) {
+    texture = newTexture;
+    if (texture) {
+        textureSize = Vector2f(static_cast<float>(texture->getSize().x), static_cast<float>(texture->getSize().y));
+    }
+    else {
+        textureSize = Vector2f(0, 0);
+    }
+}
+
+void SpriteBatch::clear() {
+    vertices.clear();
+}
+
+void SpriteBatch::add(float x, float y, float w, float h, Color color) {
+    float tw = textureSize.x, th = textureSize.y;
+    vertices.append(Vertex(Vector2f(x, y), color, Vector2f(0, 0)));
+    vertices.append(Vertex(Vector2f(x + w, y), color, Vector2f(tw, 0)));
+    vertices.append(Vertex(Vector2f(x + w, y + h), color, Vector2f(tw, th)));
+    vertices.append(Vertex(Vector2f(x, y + h), color, Vector2f(0, th)));
+}
+
+void SpriteBatch::addEntities(const EntityStore& store, Color color) {
+    for (size_t i = 0; i < store.size(); i++) {
+        if (store.alive[i]) {
+            add(store.x[i], store.y[i], store.w[i], store.h[i], color);
+        }
+    }
+}
+
+void SpriteBatch::addEntities(const EntitySnapshot& entities, float lag, Color color) {
+    for (size_t i = 0; i < entities.size(); i++) {
+        add(entities.x[i] - entities.vx[i] * lag, entities.y[i] - entities.vy[i] * lag, entities.w[i], entities.h[i], color);
+    }
+}
+
+void SpriteBatch::addParticles(const ParticleSystem& particles) {
+    //Written in place rather than appended; this runs over up to PARTICLE_CAPACITY particles a frame
+    size_t base = vertices.getVertexCount();
+    vertices.resize(base + particles.size() * 4);
+    const float* x = particles.xs();
+    const float* y = particles.ys();
+    const float* sizes = particles.sizes();
+    const unsigned* colors = particles.colors();
+    for (size_t i = 0; i < particles.size(); i++) {
+        unsigned rgba = colors[i];
+        Color color(static_cast<Uint8>(rgba >> 24), static_cast<Uint8>(rgba >> 16), static_cast<Uint8>(rgba >> 8),
+                    static_cast<Uint8>((rgba & 0xFF) * min(particles.fade(i), 1.0f)));
+        float half = sizes[i] / 2;
+        Vertex* quad = &vertices[base + i * 4];
+        quad[0] = Vertex(Vector2f(x[i] - half, y[i] - half), color);
+        quad[1] = Vertex(Vector2f(x[i] + half, y[i] - half), color);
+        quad[2] = Vertex(Vector2f(x[i] + half, y[i] + half), color);
+        quad[3] = Vertex(Vector2f(x[i] - half, y[i] + half), color);
+    }
+}
+
+void SpriteBatch::draw(RenderTarget& target, RenderStats& stats) const {
+    if (vertices.getVertexCount() == 0) {
+        return;
+    }
+    RenderStates states;
+    states.texture = texture;
+    target.draw(vertices, states);
+    stats.drawCalls++;
+    stats.quads += static_cast<int>(quadCount());
+}
+
+void drawCounted(RenderTarget& target, const Drawable& drawable, RenderStats& stats) {
+    target.draw(drawable);
+    stats.drawCalls++;
+}
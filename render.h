@@ -0,0 +1,47 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include "entities.h"
+#include "particles.h"
+#include "snapshot.h"
+
+// Batched drawing: every entity of one kind goes into a single quad vertex
+// array and is submitted with one draw call. The arrays are cleared, not
+// freed, between frames so their storage is reused.
+
+struct RenderStats {
+    int drawCalls = 0;
+    int quads = 0;
+    long long frames = 0;
+    long long totalDrawCalls = 0;
+    int maxDrawCalls = 0;
+
+    void beginFrame();
+    void endFrame();
+    double averageDrawCalls() const;
+};
+
+class SpriteBatch {
+public:
+    //A null texture draws flat-coloured quads (used for bullets)
+    explicit SpriteBatch(const sf::Texture* texture = nullptr);
+
+    void setTexture(const sf::Texture* texture);
+    void clear();
+    void add(float x, float y, float w, float h, sf::Color color = sf::Color::White);
+    void addEntities(const EntityStore& store, sf::Color color = sf::Color::White);
+    //Draws each entity lag seconds behind its snapshot position
+    void addEntities(const EntitySnapshot& entities, float lag, sf::Color color = sf::Color::White);
+    //One square per live particle, fading out with its remaining life
+    void addParticles(const ParticleSystem& particles);
+    void draw(sf::RenderTarget& target, RenderStats& stats) const;
+    size_t quadCount() const { return vertices.getVertexCount() / 4; }
+
+private:
+    const sf::Texture* texture;
+    sf::Vector2f textureSize;
+    sf::VertexArray vertices;
+};
+
+//Draws a single drawable and counts it
+void drawCounted(sf::RenderTarget& target, const sf::Drawable& drawable, RenderStats& stats);
@@ -0,0 +1,186 @@
+#include "replay.h"
+#include <algorithm>
+#include <fstream>
+
+using namespace std;
+
+unsigned char packInput(const GameInput& input) {
+    return static_cast<unsigned char>(
+        (input.left ? 1 : 0) | (input.right ? 2 : 0) | (input.up ? 4 : 0) | (input.down ? 8 : 0) | (input.fire ? 16 : 0));
+}
+
+GameInput unpackInput(unsigned char bits) {
+    GameInput input;
+    input.left = (bits & 1) != 0;
+    input.right = (bits & 2) != 0;
+    input.up = (bits & 4) != 0;
+    input.down = (bits & 8) != 0;
+    input.fire = (bits & 16) != 0;
+    return input;
+}
+
+void Replay::begin(const Game& game) {
+    seed = game.seed;
+    config = game.config;
+    timeline = activeTimeline(game);
+    masks = game.masks ? *game.masks : CollisionMasks();
+    inputs.clear();
+    checksum = 0;
+    score = 0;
+}
+
+void Replay::finish(const Game& game) {
+    checksum = gameChecksum(game);
+    score = game.score;
+}
+
+template <class T>
+static void writeValue(ofstream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <class T>
+static bool readValue(ifstream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+static void writeVarint(ofstream& out, unsigned long long value) {
+    while (value >= 0x80) {
+        out.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+static bool readVarint(ifstream& in, unsigned long long& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == EOF) {
+            return false;
+        }
+        value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void writeMask(ofstream& out, const CollisionMask& mask) {
+    writeValue(out, mask.width);
+    writeValue(out, mask.height);
+    out.write(reinterpret_cast<const char*>(mask.bits.data()), mask.bits.size() * sizeof(mask.bits[0]));
+}
+
+static bool readMask(ifstream& in, CollisionMask& mask) {
+    mask = CollisionMask();
+    int width = 0, height = 0;
+    if (!readValue(in, width) || !readValue(in, height) || width < 0 || height < 0 || width > 4096 || height > 4096) {
+        return false;
+    }
+    if (width == 0 || height == 0) {
+        return true;
+    }
+    mask.width = width;
+    mask.height = height;
+    mask.words = (width + 63) / 64;
+    mask.bits.resize(static_cast<size_t>(mask.words) * height);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(mask.bits.data()), mask.bits.size() * sizeof(mask.bits[0])));
+}
+
+bool saveReplay(const string& path, const Replay& replay) {
+    ofstream out(path, ios::binary);
+    if (!out.is_open()) {
+        return false;
+    }
+    out.write("RBRP", 4);
+    writeValue(out, REPLAY_VERSION);
+    writeValue(out, replay.seed);
+    writeValue(out, replay.config);
+    writeValue(out, replay.timeline.loopTicks);
+    writeValue(out, static_cast<unsigned long long>(replay.timeline.events.size()));
+    out.write(reinterpret_cast<const char*>(replay.timeline.events.data()), replay.timeline.events.size() * sizeof(SpawnEvent));
+    writeMask(out, replay.masks.player);
+    writeMask(out, replay.masks.alien);
+    writeMask(out, replay.masks.heart);
+    writeValue(out, static_cast<unsigned long long>(replay.inputs.size()));
+    writeValue(out, replay.checksum);
+    writeValue(out, replay.score);
+
+    //Run-length encode the per-tick input bytes
+    size_t i = 0;
+    while (i < replay.inputs.size()) {
+        size_t run = 1;
+        while (i + run < replay.inputs.size() && replay.inputs[i + run] == replay.inputs[i]) {
+            run++;
+        }
+        out.put(static_cast<char>(replay.inputs[i]));
+        writeVarint(out, run);
+        i += run;
+    }
+    return static_cast<bool>(out);
+}
+
+bool loadReplay(const string& path, Replay& replay) {
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    char magic[4];
+    unsigned version = 0;
+    unsigned long long ticks = 0;
+    unsigned long long events = 0;
+    if (!in.read(magic, 4) || string(magic, 4) != "RBRP" ||
+        !readValue(in, version) || version != REPLAY_VERSION ||
+        !readValue(in, replay.seed) || !readValue(in, replay.config) ||
+        !readValue(in, replay.timeline.loopTicks) || !readValue(in, events)) {
+        return false;
+    }
+    //Read in pieces so a corrupt count fails at end of file instead of allocating it all
+    replay.timeline.events.clear();
+    while (replay.timeline.events.size() < events) {
+        size_t batch = static_cast<size_t>(min<unsigned long long>(events - replay.timeline.events.size(), 4096));
+        size_t offset = replay.timeline.events.size();
+        replay.timeline.events.resize(offset + batch);
+        if (!in.read(reinterpret_cast<char*>(replay.timeline.events.data() + offset), batch * sizeof(SpawnEvent))) {
+            return false;
+        }
+    }
+    //step() spawns from these as they are, so they must be events a wave script could produce
+    string error;
+    if (!checkTimeline(replay.timeline, error)) {
+        return false;
+    }
+    if (!readMask(in, replay.masks.player) || !readMask(in, replay.masks.alien) || !readMask(in, replay.masks.heart) ||
+        !readValue(in, ticks) || !readValue(in, replay.checksum) || !readValue(in, replay.score)) {
+        return false;
+    }
+
+    //No reserve(ticks): the count comes from the file, so the runs actually read grow the vector
+    replay.inputs.clear();
+    while (replay.inputs.size() < ticks) {
+        int bits = in.get();
+        unsigned long long run = 0;
+        if (bits == EOF || !readVarint(in, run) || run > ticks - replay.inputs.size()) {
+            return false;
+        }
+        replay.inputs.insert(replay.inputs.end(), static_cast<size_t>(run), static_cast<unsigned char>(bits));
+    }
+    return true;
+}
+
+bool verifyReplay(const Replay& replay, unsigned long long* checksumOut) {
+    Game game;
+    game.timeline = &replay.timeline;
+    game.masks = &replay.masks;
+    resetGame(game, replay.config, replay.seed);
+    for (unsigned char bits : replay.inputs) {
+        step(game, TICK_DT, unpackInput(bits));
+    }
+    unsigned long long checksum = gameChecksum(game);
+    if (checksumOut) {
+        *checksumOut = checksum;
+    }
+    return checksum == replay.checksum;
+}
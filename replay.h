@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "game.h"
+
+// Deterministic input recording. A replay is the seed, the config and one
+// input byte per tick. Replaying those inputs through step() rebuilds the
+// exact same game, and the checksum stored at the end confirms it.
+//
+// File layout (little-endian): "RBRP", version, seed, config, spawn timeline
+// (loop length, event count, events), collision masks (player, alien, heart:
+// width, height, then the words of each row; 0 x 0 when boxes were used),
+// tick count, final checksum, final score, then the inputs as (byte, varint
+// run length) pairs. Held keys produce long runs, so a minute of play is
+// usually a few hundred bytes plus the wave script and masks it was played on.
+
+const unsigned REPLAY_VERSION = 4;
+
+unsigned char packInput(const GameInput& input);
+GameInput unpackInput(unsigned char bits);
+
+struct Replay {
+    unsigned long long seed = 1;
+    GameConfig config;
+    SpawnTimeline timeline;
+    //Empty when the game collided on boxes alone
+    CollisionMasks masks;
+    std::vector<unsigned char> inputs;
+    unsigned long long checksum = 0;
+    int score = 0;
+
+    void begin(const Game& game);
+    void record(const GameInput& input) { inputs.push_back(packInput(input)); }
+    void finish(const Game& game);
+};
+
+bool saveReplay(const std::string& path, const Replay& replay);
+//False on a truncated file or a timeline checkTimeline() refuses
+bool loadReplay(const std::string& path, Replay& replay);
+
+//Runs the whole replay without rendering; true if the checksum matches
+bool verifyReplay(const Replay& replay, unsigned long long* checksumOut = nullptr);
@@ -0,0 +1,89 @@
+#include "resolution.h"
+#include <SFML/OpenGL.hpp>
+#include <algorithm>
+#include <cmath>
+
+using namespace sf;
+using namespace std;
+
+//Smoothing of the frame-time average; about ten frames, a sixth of a second at 60 fps
+const float AVERAGE_WEIGHT = 0.1f;
+//Frames to wait after a change before judging the new scale
+const int SETTLE_FRAMES = 30;
+//Frames the average must stay under HEADROOM of the budget before stepping up
+const int HEADROOM_FRAMES = 120;
+const float HEADROOM = 0.7f;
+
+ResolutionScaler::ResolutionScaler(float budgetMillis, float minScale, float maxScale)
+    : budgetMillis(budgetMillis), minScale(minScale), maxScale(maxScale), current(maxScale), lowest(maxScale) {
+}
+
+bool ResolutionScaler::update(float frameMillis) {
+    average = average > 0 ? average + (frameMillis - average) * AVERAGE_WEIGHT : frameMillis;
+    if (budgetMillis <= 0) {
+        return false;
+    }
+    if (settleFrames > 0) {
+        settleFrames--;
+        return false;
+    }
+
+    float next = current;
+    if (average > budgetMillis) {
+        //Render cost goes with the pixel count, so shrink each side by the square root of the overshoot
+        next = current * sqrt(budgetMillis / average);
+        next = floor(next / RESOLUTION_STEP) * RESOLUTION_STEP;
+        headroomFrames = 0;
+    }
+    else if (average < budgetMillis * HEADROOM) {
+        if (++headroomFrames >= HEADROOM_FRAMES) {
+            next = current + RESOLUTION_STEP;
+            headroomFrames = 0;
+        }
+    }
+    else {
+        headroomFrames = 0;
+    }
+
+    next = min(max(next, minScale), maxScale);
+    if (fabs(next - current) < RESOLUTION_STEP / 2) {
+        return false;
+    }
+    current = next;
+    lowest = min(lowest, current);
+    changeCount++;
+    settleFrames = SETTLE_FRAMES;
+    return true;
+}
+
+void finishRendering() {
+    glFinish();
+}
+
+bool ScaledTarget::create(unsigned width, unsigned height) {
+    if (!texture.create(width, height)) {
+        return false;
+    }
+    texture.setSmooth(true);
+    sprite.setTexture(texture.getTexture());
+    logicalSize = Vector2f(static_cast<float>(width), static_cast<float>(height));
+    return true;
+}
+
+RenderTarget& ScaledTarget::begin(float newScale) {
+    scale = newScale;
+    texture.clear();
+    View view(FloatRect(0, 0, logicalSize.x, logicalSize.y));
+    view.setViewport(FloatRect(0, 0, scale, scale));
+    texture.setView(view);
+    return texture;
+}
+
+void ScaledTarget::present(RenderTarget& target, RenderStats& stats) {
+    texture.display();
+    int width = max(1, static_cast<int>(lround(logicalSize.x * scale)));
+    int height = max(1, static_cast<int>(lround(logicalSize.y * scale)));
+    sprite.setTextureRect(IntRect(0, 0, width, height));
+    sprite.setScale(logicalSize.x / width, logicalSize.y / height);
+    drawCounted(target, sprite, stats);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include "render.h"
+
+// Dynamic resolution for the playfield. The game draws in fixed logical
+// coordinates (WINDOW_WIDTH x WINDOW_HEIGHT) into an off-screen texture
+// whose used area shrinks or grows with the scale, and the result is
+// stretched over the window. The texture is allocated once at full size;
+// a lower scale just renders into its top-left corner through a smaller
+// viewport, so changing the scale never reallocates anything.
+//
+// ResolutionScaler picks the scale from measured frame times: it drops
+// quickly when the average goes over budget and creeps back up one step at
+// a time once there is clear headroom. A frame is timed from its start up
+// to the buffer swap, after finishRendering(), so work the GL driver defers
+// to the swap (all of it, on software rasterizers) is counted and the vsync
+// wait is not.
+
+const float DEFAULT_RENDER_BUDGET_MS = 12.0f;
+const float MIN_RESOLUTION_SCALE = 0.5f;
+const float MAX_RESOLUTION_SCALE = 1.0f;
+const float RESOLUTION_STEP = 0.05f;
+
+class ResolutionScaler {
+public:
+    explicit ResolutionScaler(float budgetMillis = DEFAULT_RENDER_BUDGET_MS, float minScale = MIN_RESOLUTION_SCALE,
+                              float maxScale = MAX_RESOLUTION_SCALE);
+
+    //Feeds one frame's time; true if the scale changed
+    bool update(float frameMillis);
+
+    float scale() const { return current; }
+    float budget() const { return budgetMillis; }
+    float averageMillis() const { return average; }
+    int changes() const { return changeCount; }
+    float lowestScale() const { return lowest; }
+
+private:
+    float budgetMillis;
+    float minScale, maxScale;
+    float current;
+    float average = 0;
+    int settleFrames = 0;
+    int headroomFrames = 0;
+    int changeCount = 0;
+    float lowest;
+};
+
+//Blocks until the GL driver has carried out everything drawn so far (glFinish)
+void finishRendering();
+
+class ScaledTarget {
+public:
+    //Allocates the full-size texture; false if render textures are unavailable
+    bool create(unsigned width, unsigned height);
+
+    //Clears the texture and maps logical coordinates onto its scaled corner
+    sf::RenderTarget& begin(float scale);
+    //Stretches the rendered corner over the whole target
+    void present(sf::RenderTarget& target, RenderStats& stats);
+
+private:
+    sf::RenderTexture texture;
+    sf::Sprite sprite;
+    sf::Vector2f logicalSize;
+    float scale = 1.0f;
+};
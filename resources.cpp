@@ -0,0 +1,258 @@
+#include "resources.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+using namespace sf;
+using namespace std;
+
+static long long fileSize(const string& path) {
+    ifstream file(path, ios::binary | ios::ate);
+    return file.is_open() ? static_cast<long long>(file.tellg()) : 0;
+}
+
+ResourceCache::ResourceCache() {
+}
+
+bool ResourceCache::mount(const string& path) {
+    return pack.open(path);
+}
+
+const PackEntry* ResourceCache::packed(const string& path) const {
+    return pack.isOpen() ? pack.find(path) : nullptr;
+}
+
+long long ResourceCache::assetBytes(const string& path) const {
+    const PackEntry* entry = packed(path);
+    return entry ? static_cast<long long>(entry->size) : fileSize(path);
+}
+
+ResourceCache::~ResourceCache() {
+    //Stop handing out work and wait for whatever is mid-decode
+    nextJob = jobs.size();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+static bool isImagePath(const string& path) {
+    string ext = path.substr(path.find_last_of('.') + 1);
+    return ext == "png" || ext == "jpg" || ext == "jpeg" || ext == "bmp" || ext == "tga";
+}
+
+template <class T, class Load>
+T* ResourceCache::lookup(map<string, unique_ptr<T>>& cache, const string& path, const char* kind, Load load) {
+    AssetStats& stat = assetStats[path];
+    stat.requests++;
+
+    auto found = cache.find(path);
+    if (found != cache.end()) {
+        return found->second.get();
+    }
+
+    //First request: load it and remember the result, even a failure
+    Clock timer;
+    unique_ptr<T> asset(new T());
+    const PackEntry* entry = packed(path);
+    bool ok = load(*asset, path, entry);
+    stat.kind = kind;
+    stat.loads++;
+    stat.milliseconds += timer.getElapsedTime().asMicroseconds() / 1000.0;
+    stat.bytes = assetBytes(path);
+    stat.packed = entry != nullptr;
+    stat.ok = ok;
+    if (!ok) {
+        asset.reset();
+    }
+
+    T* result = asset.get();
+    cache[path] = move(asset);
+    return result;
+}
+
+//Packed images and sounds are already decoded; anything else packed is the original file
+Texture* ResourceCache::texture(const string& path) {
+    finishPending(path);
+    return lookup(textures, path, "texture", [this](Texture& t, const string& p, const PackEntry* e) {
+        if (!e) return t.loadFromFile(p);
+        if (e->kind != PACK_IMAGE) return t.loadFromMemory(pack.data(*e), static_cast<size_t>(e->size));
+        if (!t.create(e->a, e->b)) return false;
+        t.update(pack.data(*e));
+        return true;
+    });
+}
+
+Font* ResourceCache::font(const string& path) {
+    return lookup(fonts, path, "font", [this](Font& f, const string& p, const PackEntry* e) {
+        return e ? f.loadFromMemory(pack.data(*e), static_cast<size_t>(e->size)) : f.loadFromFile(p);
+    });
+}
+
+SoundBuffer* ResourceCache::sound(const string& path) {
+    finishPending(path);
+    return lookup(sounds, path, "sound", [this](SoundBuffer& s, const string& p, const PackEntry* e) {
+        if (!e) return s.loadFromFile(p);
+        if (e->kind != PACK_SOUND) return s.loadFromMemory(pack.data(*e), static_cast<size_t>(e->size));
+        const Int16* samples = reinterpret_cast<const Int16*>(pack.data(*e));
+        return s.loadFromSamples(samples, e->size / sizeof(Int16), e->a, e->b);
+    });
+}
+
+Music* ResourceCache::music(const string& path) {
+    return lookup(musics, path, "music", [this](Music& m, const string& p, const PackEntry* e) {
+        return e && e->kind == PACK_RAW ? m.openFromMemory(pack.data(*e), static_cast<size_t>(e->size)) : m.openFromFile(p);
+    });
+}
+
+void ResourceCache::preload(const vector<string>& paths) {
+    if (!jobs.empty()) {
+        return;
+    }
+    for (const auto& path : paths) {
+        //Packed assets need no decode, so the first request loads them on the spot
+        if (textures.count(path) || sounds.count(path) || packed(path)) {
+            continue;
+        }
+        unique_ptr<PreloadJob> job(new PreloadJob());
+        job->path = path;
+        job->isTexture = isImagePath(path);
+        jobs.push_back(move(job));
+    }
+
+    unsigned threads = max(1u, thread::hardware_concurrency());
+    threads = min(threads, static_cast<unsigned>(jobs.size()));
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back(&ResourceCache::workerLoop, this);
+    }
+}
+
+void ResourceCache::workerLoop() {
+    size_t index;
+    while ((index = nextJob++) < jobs.size()) {
+        decode(*jobs[index]);
+    }
+}
+
+//Worker thread: decode only, nothing that touches the GPU or the caches
+void ResourceCache::decode(PreloadJob& job) {
+    auto start = chrono::steady_clock::now();
+    if (job.isTexture) {
+        job.ok = job.image.loadFromFile(job.path);
+    }
+    else {
+        InputSoundFile file;
+        job.ok = file.openFromFile(job.path);
+        if (job.ok) {
+            job.channels = file.getChannelCount();
+            job.sampleRate = file.getSampleRate();
+            job.samples.resize(static_cast<size_t>(file.getSampleCount()));
+            job.samples.resize(static_cast<size_t>(file.read(job.samples.data(), job.samples.size())));
+        }
+    }
+    job.decodeMilliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    job.done.store(true, memory_order_release);
+}
+
+//Render thread: turn decoded data into the cached asset
+void ResourceCache::upload(PreloadJob& job) {
+    Clock timer;
+    AssetStats& stat = assetStats[job.path];
+    stat.kind = job.isTexture ? "texture" : "sound";
+    stat.loads++;
+    stat.preloaded = true;
+    stat.bytes = assetBytes(job.path);
+    stat.decodeMilliseconds = job.decodeMilliseconds;
+
+    bool ok = job.ok;
+    if (job.isTexture) {
+        unique_ptr<Texture> texture(new Texture());
+        ok = ok && texture->loadFromImage(job.image);
+        textures[job.path] = ok ? move(texture) : nullptr;
+        job.image = Image();
+    }
+    else {
+        unique_ptr<SoundBuffer> buffer(new SoundBuffer());
+        ok = ok && buffer->loadFromSamples(job.samples.data(), job.samples.size(), job.channels, job.sampleRate);
+        sounds[job.path] = ok ? move(buffer) : nullptr;
+        vector<Int16>().swap(job.samples);
+    }
+    stat.ok = ok;
+    stat.uploadMilliseconds = timer.getElapsedTime().asMicroseconds() / 1000.0;
+    stat.milliseconds = stat.decodeMilliseconds + stat.uploadMilliseconds;
+
+    job.uploaded = true;
+    uploadedJobs++;
+    if (uploadedJobs == jobs.size()) {
+        preloadMilliseconds = startupClock.getElapsedTime().asMicroseconds() / 1000.0;
+    }
+}
+
+void ResourceCache::finishPending(const string& path) {
+    if (uploadedJobs == jobs.size()) {
+        return;
+    }
+    for (auto& job : jobs) {
+        if (job->path == path && !job->uploaded) {
+            while (!job->done.load(memory_order_acquire)) {
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+            upload(*job);
+        }
+    }
+}
+
+void ResourceCache::pump(int maxUploads) {
+    for (auto& job : jobs) {
+        if (maxUploads <= 0) {
+            break;
+        }
+        if (!job->uploaded && job->done.load(memory_order_acquire)) {
+            upload(*job);
+            maxUploads--;
+        }
+    }
+}
+
+bool ResourceCache::preloading() const {
+    return uploadedJobs < jobs.size();
+}
+
+float ResourceCache::progress() const {
+    return jobs.empty() ? 1.0f : static_cast<float>(uploadedJobs) / jobs.size();
+}
+
+void ResourceCache::markInteractive() {
+    if (interactiveMilliseconds < 0) {
+        interactiveMilliseconds = startupClock.getElapsedTime().asMicroseconds() / 1000.0;
+    }
+}
+
+void ResourceCache::printStartupReport(ostream& out) const {
+    out << "Startup:" << endl;
+    out << "  first interactive frame " << fixed << setprecision(2) << interactiveMilliseconds << " ms" << endl;
+    out << "  all preloads ready      " << preloadMilliseconds << " ms" << endl;
+    for (const auto& entry : assetStats) {
+        const AssetStats& stat = entry.second;
+        if (stat.preloaded) {
+            out << "  " << left << setw(32) << entry.first << right << " decode " << setw(8) << stat.decodeMilliseconds
+                << " ms  upload " << setw(8) << stat.uploadMilliseconds << " ms" << (stat.ok ? "" : "  FAILED") << endl;
+        }
+    }
+}
+
+void ResourceCache::printReport(ostream& out) const {
+    long long totalBytes = 0;
+    double totalMs = 0;
+    out << "Asset report:" << endl;
+    for (const auto& entry : assetStats) {
+        const AssetStats& stat = entry.second;
+        out << "  " << left << setw(8) << stat.kind << " " << setw(32) << entry.first
+            << right << " loads " << stat.loads << "  requests " << setw(3) << stat.requests
+            << "  " << setw(9) << stat.bytes << " bytes  " << fixed << setprecision(2) << setw(8) << stat.milliseconds << " ms"
+            << (stat.packed ? "  packed" : "") << (stat.ok ? "" : "  FAILED") << endl;
+        totalBytes += stat.bytes;
+        totalMs += stat.milliseconds;
+    }
+    out << "  total " << totalBytes << " bytes, " << fixed << setprecision(2) << totalMs << " ms" << endl;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <SFML/Audio.hpp>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "asset_pack.h"
+
+// Loads every texture, font, sound buffer and music stream at most once per
+// process, keyed by path, and hands out shared pointers into the cache.
+// A failed load is remembered too, so a missing file is not retried on every
+// menu entry. Lookups return nullptr on failure.
+//
+// preload() decodes images and audio on worker threads. The decoded data is
+// turned into sf::Texture / sf::SoundBuffer by pump() on the render thread,
+// a few assets per frame. Asking for an asset that is still being decoded
+// waits for that one asset only.
+//
+// With an asset archive mounted, packed assets skip the decode altogether:
+// textures and sound buffers are filled straight from the mapped RGBA and
+// PCM bytes, and fonts and music read their original bytes from the mapping.
+// Paths that are not in the archive still load from their loose files.
+
+struct AssetStats {
+    std::string kind;
+    int loads = 0;
+    int requests = 0;
+    long long bytes = 0;
+    double milliseconds = 0;
+    double decodeMilliseconds = 0;
+    double uploadMilliseconds = 0;
+    bool preloaded = false;
+    bool packed = false;
+    bool ok = false;
+};
+
+class ResourceCache {
+public:
+    ResourceCache();
+    ~ResourceCache();
+    ResourceCache(const ResourceCache&) = delete;
+    ResourceCache& operator=(const ResourceCache&) = delete;
+
+    sf::Texture* texture(const std::string& path);
+    sf::Font* font(const std::string& path);
+    sf::SoundBuffer* sound(const std::string& path);
+    sf::Music* music(const std::string& path);
+
+    //Maps an archive written by the packer; false (and loose files only) if it is missing or damaged
+    bool mount(const std::string& path);
+    bool mounted() const { return pack.isOpen(); }
+
+    //Background loading
+    void preload(const std::vector<std::string>& paths);
+    void pump(int maxUploads = 2);
+    bool preloading() const;
+    float progress() const;
+
+    //Call after each presented frame; the first call is time-to-interactive
+    void markInteractive();
+
+    const std::map<std::string, AssetStats>& stats() const { return assetStats; }
+    void printReport(std::ostream& out) const;
+    void printStartupReport(std::ostream& out) const;
+
+private:
+    struct PreloadJob {
+        std::string path;
+        bool isTexture = false;
+        std::atomic<bool> done{ false };
+        bool uploaded = false;
+        bool ok = false;
+        sf::Image image;
+        std::vector<sf::Int16> samples;
+        unsigned channels = 0;
+        unsigned sampleRate = 0;
+        double decodeMilliseconds = 0;
+    };
+
+    template <class T, class Load>
+    T* lookup(std::map<std::string, std::unique_ptr<T>>& cache, const std::string& path, const char* kind, Load load);
+
+    void decode(PreloadJob& job);
+    void upload(PreloadJob& job);
+    void finishPending(const std::string& path);
+    void workerLoop();
+    const PackEntry* packed(const std::string& path) const;
+    long long assetBytes(const std::string& path) const;
+
+    //Declared first so the mapping outlives the fonts and music reading from it
+    AssetPack pack;
+    std::map<std::string, std::unique_ptr<sf::Texture>> textures;
+    std::map<std::string, std::unique_ptr<sf::Font>> fonts;
+    std::map<std::string, std::unique_ptr<sf::SoundBuffer>> sounds;
+    std::map<std::string, std::unique_ptr<sf::Music>> musics;
+    std::map<std::string, AssetStats> assetStats;
+
+    std::vector<std::unique_ptr<PreloadJob>> jobs;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> nextJob{ 0 };
+    size_t uploadedJobs = 0;
+
+    sf::Clock startupClock;
+    double preloadMilliseconds = -1;
+    double interactiveMilliseconds = -1;
+};
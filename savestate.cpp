@@ -0,0 +1,375 @@
+#include "savestate.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include "mapped_file.h"
+
+using namespace std;
+
+namespace {
+
+struct StateHeader {
+    char magic[4];
+    unsigned version;
+    unsigned long long tick;
+    unsigned long long seed;
+    unsigned long long rngState;
+    unsigned long long timelineCursor;
+    unsigned long long timelineStart;
+    //timelineHash() of the timeline the game follows; resuming on another one would diverge
+    unsigned long long timelineId;
+    GameConfig config;
+    float playerX, playerY;
+    int score;
+    int hearts;
+    int shootTicks;
+    unsigned over;
+    //Bullets, aliens, hearts
+    unsigned long long counts[3];
+};
+
+//Six float arrays and the alive flags
+const size_t ENTITY_BYTES = 6 * sizeof(float) + 1;
+//Far beyond any real wave; a larger count means the state is damaged
+const unsigned long long MAX_STATE_ENTITIES = 1 << 22;
+
+}
+
+static unsigned char* writeStore(unsigned char* out, const EntityStore& store) {
+    size_t n = store.size();
+    for (const vector<float>* values : { &store.x, &store.y, &store.vx, &store.vy, &store.w, &store.h }) {
+        memcpy(out, values->data(), n * sizeof(float));
+        out += n * sizeof(float);
+    }
+    memcpy(out, store.alive.data(), n);
+    return out + n;
+}
+
+static const unsigned char* readStore(const unsigned char* in, size_t n, EntityStore& store) {
+    store.resetTo(n);
+    for (vector<float>* values : { &store.x, &store.y, &store.vx, &store.vy, &store.w, &store.h }) {
+        memcpy(values->data(), in, n * sizeof(float));
+        in += n * sizeof(float);
+    }
+    memcpy(store.alive.data(), in, n);
+    return in + n;
+}
+
+void SaveState::capture(const Game& game) {
+    capture(game, timelineHash(activeTimeline(game)));
+}
+
+void SaveState::capture(const Game& game, unsigned long long timelineId) {
+    const EntityStore* stores[3] = { &game.bullets, &game.aliens, &game.bonusHearts };
+    StateHeader header;
+    //Zeroed so padding bytes are the same in every file
+    memset(static_cast<void*>(&header), 0, sizeof(header));
+    memcpy(header.magic, "RBST", 4);
+    header.version = SAVE_STATE_VERSION;
+    header.tick = game.tick;
+    header.seed = game.seed;
+    header.rngState = game.rng.state;
+    header.timelineCursor = game.timelineCursor;
+    header.timelineStart = game.timelineStart;
+    header.timelineId = timelineId;
+    header.config = game.config;
+    header.playerX = game.playerX;
+    header.playerY = game.playerY;
+    header.score = game.score;
+    header.hearts = game.hearts;
+    header.shootTicks = game.shootTicks;
+    header.over = game.over ? 1 : 0;
+    size_t needed = sizeof(header);
+    for (int i = 0; i < 3; i++) {
+        header.counts[i] = stores[i]->size();
+        needed += stores[i]->size() * ENTITY_BYTES;
+    }
+
+    //Grow with headroom, so a wave a little larger than the last one does not allocate again
+    if (bytes.size() < needed) {
+        bytes.resize(needed + needed / 2);
+    }
+    unsigned char* out = bytes.data();
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    for (const EntityStore* store : stores) {
+        out = writeStore(out, *store);
+    }
+    used = needed;
+}
+
+//The header, if the bytes hold a whole state of this version
+static bool readHeader(const vector<unsigned char>& bytes, size_t used, StateHeader& header) {
+    if (used < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, bytes.data(), sizeof(header));
+    if (memcmp(header.magic, "RBST", 4) != 0 || header.version != SAVE_STATE_VERSION) {
+        return false;
+    }
+    size_t expected = sizeof(header);
+    for (unsigned long long count : header.counts) {
+        if (count > MAX_STATE_ENTITIES || count > used / ENTITY_BYTES) {
+            return false;
+        }
+        expected += static_cast<size_t>(count) * ENTITY_BYTES;
+    }
+    return expected == used;
+}
+
+static bool finiteValues(const unsigned char* in, size_t count) {
+    for (size_t i = 0; i < count; i++, in += sizeof(float)) {
+        float value;
+        memcpy(&value, in, sizeof(value));
+        if (!isfinite(value)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//Everything step() and the front end index with or divide by is in range
+static bool sensibleHeader(const StateHeader& header) {
+    const GameConfig& config = header.config;
+    int level = static_cast<int>(config.level);
+    for (float value : { config.alienSpeed, config.playerWidth, config.playerHeight, config.alienWidth, config.alienHeight,
+                         config.heartWidth, config.heartHeight }) {
+        if (!isfinite(value) || value < 0) {
+            return false;
+        }
+    }
+    return level >= 0 && level < 3 && config.maxBullets >= 0 &&
+           isfinite(header.playerX) && isfinite(header.playerY) &&
+           header.score >= 0 && header.shootTicks >= 0 && header.over <= 1 &&
+           header.hearts <= MAX_HEARTS && (header.hearts > 0 || header.over) &&
+           header.timelineStart <= header.tick;
+}
+
+//Entity values follow the header: finite floats, alive flags of 0 or 1
+static bool sensiblePayload(const unsigned char* in, const StateHeader& header) {
+    for (unsigned long long count : header.counts) {
+        size_t n = static_cast<size_t>(count);
+        if (!finiteValues(in, 6 * n)) {
+            return false;
+        }
+        in += 6 * n * sizeof(float);
+        for (size_t i = 0; i < n; i++) {
+            if (in[i] > 1) {
+                return false;
+            }
+        }
+        in += n;
+    }
+    return true;
+}
+
+//Header and payload, if the bytes hold a whole, sensible state
+static bool checkState(const vector<unsigned char>& bytes, size_t used, StateHeader& header) {
+    return readHeader(bytes, used, header) && sensibleHeader(header) && sensiblePayload(bytes.data() + sizeof(header), header);
+}
+
+bool SaveState::valid() const {
+    StateHeader header;
+    return checkState(bytes, used, header);
+}
+
+bool SaveState::restore(Game& game) const {
+    return restore(game, timelineHash(activeTimeline(game)));
+}
+
+bool SaveState::restore(Game& game, unsigned long long timelineId) const {
+    StateHeader header;
+    if (!checkState(bytes, used, header) || header.timelineId != timelineId ||
+        header.timelineCursor > activeTimeline(game).events.size()) {
+        return false;
+    }
+
+    game.config = header.config;
+    game.tick = header.tick;
+    game.seed = header.seed;
+    game.rng.state = header.rngState;
+    game.timelineCursor = static_cast<size_t>(header.timelineCursor);
+    game.timelineStart = header.timelineStart;
+    game.playerX = header.playerX;
+    game.playerY = header.playerY;
+    game.score = header.score;
+    game.hearts = header.hearts;
+    game.shootTicks = header.shootTicks;
+    game.over = header.over != 0;
+    game.effects.clear();
+    const unsigned char* in = bytes.data() + sizeof(header);
+    in = readStore(in, static_cast<size_t>(header.counts[0]), game.bullets);
+    in = readStore(in, static_cast<size_t>(header.counts[1]), game.aliens);
+    readStore(in, static_cast<size_t>(header.counts[2]), game.bonusHearts);
+    return true;
+}
+
+unsigned long long SaveState::tick() const {
+    StateHeader header;
+    return readHeader(bytes, used, header) ? header.tick : 0;
+}
+
+void SaveState::assign(const unsigned char* data, size_t size) {
+    if (bytes.size() < size) {
+        bytes.resize(size);
+    }
+    if (size > 0) {
+        memcpy(bytes.data(), data, size);
+    }
+    used = size;
+}
+
+bool saveStateFile(const string& path, const SaveState& state) {
+    string tempPath = path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        cerr << "Error: Could not create " << tempPath << endl;
+        return false;
+    }
+    //The state, then an FNV-1a of it, so a damaged file is refused on load
+    unsigned long long check = FNV_OFFSET_BASIS;
+    hashBytes(check, state.data(), state.size());
+    bool ok = fwrite(state.data(), 1, state.size(), file) == state.size() && fwrite(&check, sizeof(check), 1, file) == 1 && syncFile(file);
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        cerr << "Error: Could not write " << tempPath << endl;
+        return false;
+    }
+    if (!replaceFile(tempPath, path)) {
+        cerr << "Error: Could not replace " << path << endl;
+        return false;
+    }
+    return true;
+}
+
+bool loadStateFile(const string& path, SaveState& state) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    vector<unsigned char> data;
+    unsigned char chunk[4096];
+    size_t got;
+    while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + got);
+    }
+    bool ok = !ferror(file);
+    fclose(file);
+    if (!ok) {
+        return false;
+    }
+    unsigned long long stored = 0, check = FNV_OFFSET_BASIS;
+    if (data.size() < sizeof(stored)) {
+        return false;
+    }
+    size_t size = data.size() - sizeof(stored);
+    memcpy(&stored, data.data() + size, sizeof(stored));
+    hashBytes(check, data.data(), size);
+    if (stored != check) {
+        return false;
+    }
+    state.assign(data.data(), size);
+    return state.valid();
+}
+
+StateWriter::StateWriter(const string& path) : path(path) {
+    writer = thread(&StateWriter::writerLoop, this);
+}
+
+StateWriter::~StateWriter() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    ready.notify_one();
+    if (writer.joinable()) {
+        writer.join();
+    }
+}
+
+void StateWriter::submit(const SaveState& state) {
+    {
+        lock_guard<mutex> guard(lock);
+        pending.assign(state.data(), state.size());
+        hasPending = true;
+    }
+    ready.notify_one();
+}
+
+void StateWriter::discard() {
+    {
+        lock_guard<mutex> guard(lock);
+        hasPending = false;
+        discardRequested = true;
+    }
+    ready.notify_one();
+}
+
+void StateWriter::writerLoop() {
+    //Swapped with the pending slot, so both keep their capacity
+    SaveState writing;
+    while (true) {
+        bool write = false;
+        bool remove = false;
+        {
+            unique_lock<mutex> guard(lock);
+            ready.wait(guard, [&] { return stopping || hasPending || discardRequested; });
+            if (!hasPending && !discardRequested && stopping) {
+                break;
+            }
+            if (hasPending) {
+                swap(writing, pending);
+                write = true;
+            }
+            remove = discardRequested;
+            hasPending = false;
+            discardRequested = false;
+        }
+        //A state submitted after discard() is newer than the discard
+        if (remove) {
+            error_code ignored;
+            filesystem::remove(path, ignored);
+        }
+        if (write) {
+            saveStateFile(path, writing);
+        }
+    }
+}
+
+RewindBuffer::RewindBuffer(size_t ticks) : slots(max<size_t>(ticks, 1)) {
+}
+
+unsigned long long RewindBuffer::timelineId(const Game& game) {
+    //Rehashed only when the game follows another timeline, or this one changed size
+    const SpawnTimeline& timeline = activeTimeline(game);
+    if (&timeline != hashedTimeline || timeline.events.size() != hashedEvents || timeline.loopTicks != hashedLoop) {
+        hashedTimeline = &timeline;
+        hashedEvents = timeline.events.size();
+        hashedLoop = timeline.loopTicks;
+        hashedId = timelineHash(timeline);
+    }
+    return hashedId;
+}
+
+void RewindBuffer::capture(const Game& game) {
+    slots[next].capture(game, timelineId(game));
+    next = (next + 1) % slots.size();
+    count = min(count + 1, slots.size());
+}
+
+bool RewindBuffer::rewind(Game& game, size_t ticks) {
+    if (count == 0) {
+        return false;
+    }
+    size_t back = min(ticks, count - 1);
+    size_t target = (next + slots.size() - 1 - back) % slots.size();
+    if (!slots[target].restore(game, timelineId(game))) {
+        return false;
+    }
+    next = (target + 1) % slots.size();
+    count -= back;
+    return true;
+}
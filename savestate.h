@@ -0,0 +1,120 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "game.h"
+
+// Compact binary snapshots of everything step() reads: seed, config, rng,
+// timers, player, score, hearts and the three entity stores. Restoring a
+// state and stepping on gives the same ticks (and checksums) as the game it
+// was captured from. Each state records the id (timelineHash) of the spawn
+// timeline it was captured on, and restore() refuses it on any other.
+// Handles, grids, the arena and effects are not saved; step() rebuilds the
+// grids and never reads the rest.
+//
+// Layout (native byte order, like replays): a fixed header, then for each
+// of bullets, aliens and hearts the x, y, vx, vy, w and h arrays followed by
+// the alive flags. Files add an FNV-1a of the state after it. Restoring
+// checks the header and every value first (level, hearts, counts, finite
+// coordinates), so a damaged or foreign file is refused rather than
+// trusted. A state's buffer only grows, so capturing into the same
+// SaveState again is a handful of memcpy calls and never allocates once it
+// has held the largest wave. A game with a hundred entities is about 2.5 KB.
+
+const unsigned SAVE_STATE_VERSION = 2;
+//Rewind keeps this many ticks, one state per tick
+const size_t REWIND_TICKS = 10 * TICK_RATE;
+
+class SaveState {
+public:
+    void capture(const Game& game);
+    //Same, with timelineHash(activeTimeline(game)) already worked out
+    void capture(const Game& game, unsigned long long timelineId);
+    //Overwrites the game's state; false (and the game untouched) if this is
+    //not a valid state of the current version or was captured on another timeline
+    bool restore(Game& game) const;
+    bool restore(Game& game, unsigned long long timelineId) const;
+
+    bool empty() const { return used == 0; }
+    //True if the bytes hold a whole, sensible state; restore() also checks the timeline
+    bool valid() const;
+    size_t size() const { return used; }
+    const unsigned char* data() const { return bytes.data(); }
+    //Tick the state was captured at, 0 if not valid
+    unsigned long long tick() const;
+    //Raw bytes, e.g. read back from a file; checked by restore()
+    void assign(const unsigned char* data, size_t size);
+
+private:
+    std::vector<unsigned char> bytes;
+    size_t used = 0;
+};
+
+//Written to path.tmp, synced and renamed over path, so a crash mid-write keeps the old file.
+//Loading fails on a missing, damaged or invalid file
+bool saveStateFile(const std::string& path, const SaveState& state);
+bool loadStateFile(const std::string& path, SaveState& state);
+
+// Keeps one file up to date from a thread of its own, so the game never
+// waits on the disk. submit() copies the state into a slot that only grows
+// and returns; the writer saves whatever is newest when it gets to it, so
+// a slow disk skips states instead of queueing them. Pending states are
+// still written when the writer is destroyed.
+
+class StateWriter {
+public:
+    explicit StateWriter(const std::string& path);
+    ~StateWriter();
+    StateWriter(const StateWriter&) = delete;
+    StateWriter& operator=(const StateWriter&) = delete;
+
+    //Allocation-free once the slot has held a state this large
+    void submit(const SaveState& state);
+    //Drops any pending state and deletes the file, in order with earlier writes
+    void discard();
+
+private:
+    void writerLoop();
+
+    std::string path;
+    std::mutex lock;
+    std::condition_variable ready;
+    SaveState pending;
+    bool hasPending = false;
+    bool discardRequested = false;
+    bool stopping = false;
+    std::thread writer;
+};
+
+// Ring of the last few seconds of states, captured after every tick.
+// rewind() restores an older one and forgets everything newer, so play
+// simply carries on from there.
+
+class RewindBuffer {
+public:
+    explicit RewindBuffer(size_t ticks = REWIND_TICKS);
+
+    void capture(const Game& game);
+    //Goes back up to this many ticks (fewer if not that many are kept); false if none are
+    bool rewind(Game& game, size_t ticks);
+    void clear() { count = 0; }
+
+    size_t size() const { return count; }
+    size_t capacity() const { return slots.size(); }
+    //Last captured state; only valid when size() > 0
+    const SaveState& newest() const { return slots[(next + slots.size() - 1) % slots.size()]; }
+
+private:
+    unsigned long long timelineId(const Game& game);
+
+    std::vector<SaveState> slots;
+    size_t next = 0;
+    size_t count = 0;
+    const SpawnTimeline* hashedTimeline = nullptr;
+    size_t hashedEvents = 0;
+    unsigned hashedLoop = 0;
+    unsigned long long hashedId = 0;
+};
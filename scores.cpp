@@ -0,0 +1,359 @@
+#include "scores.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+
+using namespace std;
+
+static_assert(sizeof(ScoreEntry) == 32, "score records are stored raw and must stay 32 bytes");
+
+static unsigned entryCheck(const ScoreEntry& entry) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&entry);
+    unsigned hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(ScoreEntry, check); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+//Best score first; equal scores keep the earlier run first
+static bool betterScore(const ScoreEntry& a, const ScoreEntry& b) {
+    if (a.score != b.score) return a.score > b.score;
+    return a.time < b.time;
+}
+
+ScoreStore::ScoreStore(const string& directory) {
+    journalPath = directory + "/scores.journal";
+    indexPath = directory + "/scores.index";
+}
+
+ScoreStore::~ScoreStore() {
+    {
+        lock_guard<mutex> guard(queueLock);
+        stopping = true;
+    }
+    queueReady.notify_one();
+    if (writer.joinable()) {
+        writer.join();
+    }
+    if (journal) {
+        fclose(journal);
+    }
+}
+
+const ScoreEntry* ScoreStore::indexSection(int level, size_t& count) const {
+    count = 0;
+    if (index.size() < sizeof(IndexHeader)) {
+        return nullptr;
+    }
+    const IndexHeader* header = reinterpret_cast<const IndexHeader*>(index.data());
+    const ScoreEntry* records = reinterpret_cast<const ScoreEntry*>(index.data() + sizeof(IndexHeader));
+    for (int i = 0; i < level; i++) {
+        records += header->counts[i];
+    }
+    count = static_cast<size_t>(header->counts[level]);
+    return records;
+}
+
+bool ScoreStore::openIndex(MappedFile& file, unsigned long long& generation) const {
+    generation = 0;
+    if (!file.open(indexPath)) {
+        cerr << "Error: Could not map " << indexPath << endl;
+        return false;
+    }
+    //Check the header and that the file holds exactly the records it claims.
+    //Each count is bounded by the file first, so a damaged one cannot overflow the sum
+    bool valid = file.size() >= sizeof(IndexHeader);
+    if (valid) {
+        const IndexHeader* header = reinterpret_cast<const IndexHeader*>(file.data());
+        unsigned long long room = (file.size() - sizeof(IndexHeader)) / sizeof(ScoreEntry);
+        unsigned long long records = 0;
+        for (unsigned long long count : header->counts) {
+            valid = valid && count <= room;
+            records += valid ? count : 0;
+        }
+        valid = valid && memcmp(header->magic, "RBSI", 4) == 0 && header->version == SCORE_STORE_VERSION &&
+                file.size() == sizeof(IndexHeader) + records * sizeof(ScoreEntry);
+        generation = header->generation;
+    }
+    if (!valid) {
+        cerr << "Error: " << indexPath << " is damaged; ignoring it" << endl;
+        file.close();
+        generation = 0;
+    }
+    return valid;
+}
+
+bool ScoreStore::loadIndex() {
+    indexGeneration = 0;
+    if (!filesystem::exists(indexPath)) {
+        return true;
+    }
+    return openIndex(index, indexGeneration);
+}
+
+bool ScoreStore::loadJournal() {
+    MappedFile file;
+    if (!filesystem::exists(journalPath) || !file.open(journalPath) || file.size() < sizeof(JournalHeader)) {
+        return startJournal(indexGeneration + 1);
+    }
+    const JournalHeader* header = reinterpret_cast<const JournalHeader*>(file.data());
+    if (memcmp(header->magic, "RBSJ", 4) != 0 || header->version != SCORE_STORE_VERSION) {
+        cerr << "Error: " << journalPath << " is damaged; starting a new one" << endl;
+        file.close();
+        return startJournal(indexGeneration + 1);
+    }
+    journalGeneration = header->generation;
+
+    //The index already holds this journal if compaction got as far as the first rename
+    if (journalGeneration <= indexGeneration) {
+        file.close();
+        return startJournal(indexGeneration + 1);
+    }
+
+    //Keep every record up to the first one that is torn or fails its check
+    size_t available = (file.size() - sizeof(JournalHeader)) / sizeof(ScoreEntry);
+    const ScoreEntry* records = reinterpret_cast<const ScoreEntry*>(file.data() + sizeof(JournalHeader));
+    size_t good = 0;
+    while (good < available && records[good].check == entryCheck(records[good]) && records[good].level < 3) {
+        journalEntries[records[good].level].push_back(records[good]);
+        good++;
+    }
+    journalCount = good;
+    size_t goodSize = sizeof(JournalHeader) + good * sizeof(ScoreEntry);
+    bool torn = file.size() != goodSize;
+    file.close();
+
+    if (torn) {
+        cerr << "Warning: dropping a damaged tail from " << journalPath << " after " << good << " records" << endl;
+        error_code error;
+        filesystem::resize_file(journalPath, goodSize, error);
+        if (error) {
+            cerr << "Error: Could not repair " << journalPath << endl;
+            return false;
+        }
+    }
+    journal = fopen(journalPath.c_str(), "ab");
+    if (!journal) {
+        cerr << "Error: Could not open " << journalPath << endl;
+        return false;
+    }
+    return true;
+}
+
+bool ScoreStore::startJournal(unsigned long long newGeneration) {
+    if (journal) {
+        fclose(journal);
+        journal = nullptr;
+    }
+    string tempPath = journalPath + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        cerr << "Error: Could not create " << tempPath << endl;
+        return false;
+    }
+    JournalHeader header;
+    memcpy(header.magic, "RBSJ", 4);
+    header.version = SCORE_STORE_VERSION;
+    header.generation = newGeneration;
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 && syncFile(file);
+    fclose(file);
+    if (!ok || !replaceFile(tempPath, journalPath)) {
+        cerr << "Error: Could not write " << journalPath << endl;
+        return false;
+    }
+    journalGeneration = newGeneration;
+    journal = fopen(journalPath.c_str(), "ab");
+    return journal != nullptr;
+}
+
+bool ScoreStore::open() {
+    error_code error;
+    filesystem::create_directories(filesystem::path(journalPath).parent_path(), error);
+    bool ok = loadIndex();
+    ok = loadJournal() && ok;
+    writer = thread(&ScoreStore::writerLoop, this);
+    return ok;
+}
+
+void ScoreStore::submit(Level level, int score, unsigned long long seed, unsigned long long ticks) {
+    ScoreEntry entry;
+    entry.score = score;
+    entry.level = static_cast<unsigned char>(level);
+    entry.seed = seed;
+    entry.time = static_cast<long long>(::time(nullptr));
+    entry.ticks = static_cast<unsigned>(ticks);
+    entry.check = entryCheck(entry);
+    {
+        lock_guard<mutex> guard(queueLock);
+        pending.push_back(entry);
+        submitted++;
+    }
+    queueReady.notify_one();
+}
+
+void ScoreStore::flush() {
+    unique_lock<mutex> guard(queueLock);
+    unsigned long long target = submitted;
+    queueDrained.wait(guard, [&] { return written >= target || !writer.joinable(); });
+}
+
+void ScoreStore::requestCompaction() {
+    {
+        lock_guard<mutex> guard(queueLock);
+        compactRequested = true;
+    }
+    queueReady.notify_one();
+}
+
+bool ScoreStore::append(const vector<ScoreEntry>& batch) {
+    if (!journal) {
+        return false;
+    }
+    bool ok = fwrite(batch.data(), sizeof(ScoreEntry), batch.size(), journal) == batch.size() && syncFile(journal);
+    if (!ok) {
+        cerr << "Error: Could not append to " << journalPath << endl;
+        return false;
+    }
+    lock_guard<mutex> guard(stateLock);
+    for (const auto& entry : batch) {
+        journalEntries[entry.level].push_back(entry);
+    }
+    journalCount += batch.size();
+    return true;
+}
+
+bool ScoreStore::compact() {
+    //Only this thread changes the index and journal, so they can be read without the lock
+    vector<ScoreEntry> levels[3];
+    for (int level = 0; level < 3; level++) {
+        size_t count = 0;
+        const ScoreEntry* section = indexSection(level, count);
+        levels[level].reserve(count + journalEntries[level].size());
+        levels[level].insert(levels[level].end(), section, section + count);
+        levels[level].insert(levels[level].end(), journalEntries[level].begin(), journalEntries[level].end());
+        sort(levels[level].begin(), levels[level].end(), betterScore);
+    }
+
+    IndexHeader header;
+    memcpy(header.magic, "RBSI", 4);
+    header.version = SCORE_STORE_VERSION;
+    header.generation = journalGeneration;
+    for (int level = 0; level < 3; level++) {
+        header.counts[level] = levels[level].size();
+    }
+
+    string tempPath = indexPath + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (!file) {
+        cerr << "Error: Could not create " << tempPath << endl;
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int level = 0; level < 3 && ok; level++) {
+        ok = fwrite(levels[level].data(), sizeof(ScoreEntry), levels[level].size(), file) == levels[level].size();
+    }
+    ok = ok && syncFile(file);
+    fclose(file);
+    if (!ok) {
+        cerr << "Error: Could not write " << tempPath << endl;
+        return false;
+    }
+
+    //Readers keep using the old mapping and journal entries while the new files
+    //are renamed into place, and only wait for the swap at the end. Windows will
+    //not replace a file that is still mapped, so there they wait for the rename too
+    unique_lock<mutex> guard(stateLock, defer_lock);
+#ifdef _WIN32
+    guard.lock();
+    index.close();
+#endif
+    if (!replaceFile(tempPath, indexPath)) {
+        cerr << "Error: Could not replace " << indexPath << endl;
+#ifdef _WIN32
+        loadIndex();
+#endif
+        return false;
+    }
+    MappedFile fresh;
+    unsigned long long freshGeneration = 0;
+    if (!openIndex(fresh, freshGeneration) || !startJournal(journalGeneration + 1)) {
+        return false;
+    }
+    if (!guard.owns_lock()) {
+        guard.lock();
+    }
+    //The new index holds every journal entry, so both change in one step
+    index.swap(fresh);
+    indexGeneration = freshGeneration;
+    for (auto& entries : journalEntries) {
+        entries.clear();
+    }
+    journalCount = 0;
+    return true;
+}
+
+void ScoreStore::writerLoop() {
+    vector<ScoreEntry> batch;
+    while (true) {
+        bool compactNow = false;
+        {
+            unique_lock<mutex> guard(queueLock);
+            queueReady.wait(guard, [&] { return stopping || compactRequested || !pending.empty(); });
+            if (pending.empty() && stopping) {
+                break;
+            }
+            batch.swap(pending);
+            compactNow = compactRequested;
+            compactRequested = false;
+        }
+
+        if (!batch.empty()) {
+            append(batch);
+        }
+        if (compactNow || journalCount >= COMPACT_THRESHOLD) {
+            compact();
+        }
+        {
+            lock_guard<mutex> guard(queueLock);
+            written += batch.size();
+        }
+        batch.clear();
+        queueDrained.notify_all();
+    }
+}
+
+int ScoreStore::best(Level level) const {
+    vector<ScoreEntry> best;
+    top(level, 1, best);
+    return best.empty() ? 0 : best[0].score;
+}
+
+void ScoreStore::top(Level level, size_t count, vector<ScoreEntry>& out) const {
+    lock_guard<mutex> guard(stateLock);
+    size_t indexed = 0;
+    const ScoreEntry* section = indexSection(static_cast<int>(level), indexed);
+    const vector<ScoreEntry>& recent = journalEntries[static_cast<int>(level)];
+
+    //The index section is already sorted; only the journal part needs sorting
+    out.assign(section, section + min(indexed, count));
+    out.insert(out.end(), recent.begin(), recent.end());
+    size_t keep = min(count, out.size());
+    partial_sort(out.begin(), out.begin() + keep, out.end(), betterScore);
+    out.resize(keep);
+}
+
+size_t ScoreStore::totalEntries() const {
+    lock_guard<mutex> guard(stateLock);
+    size_t total = journalCount;
+    for (int level = 0; level < 3; level++) {
+        size_t count = 0;
+        indexSection(level, count);
+        total += count;
+    }
+    return total;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "game.h"
+#include "mapped_file.h"
+
+// Persistent score history with per-level leaderboards.
+//
+// Two files live in the store's directory:
+// - scores.index: every score up to the last compaction, grouped by level
+//   and sorted best first. It is memory-mapped, so the top N of a level is
+//   just the first N records of that level's section.
+// - scores.journal: scores added since then, appended as fixed 32-byte
+//   records. Each record carries a checksum, so a torn write from a crash
+//   is found and cut off on the next open.
+//
+// submit() only queues the score. A background thread appends it to the
+// journal and syncs it to disk. Once the journal passes COMPACT_THRESHOLD
+// records it is folded into a new index, written to a temporary file and
+// renamed over the old one. The journal carries a generation number and
+// the index records the generation it already includes, so a crash
+// between the two renames never counts a score twice.
+
+const unsigned SCORE_STORE_VERSION = 1;
+const size_t COMPACT_THRESHOLD = 4096;
+
+struct ScoreEntry {
+    int score = 0;
+    unsigned char level = 0;
+    unsigned char reserved[3] = {};
+    unsigned long long seed = 0;
+    long long time = 0;          // seconds since the epoch
+    unsigned ticks = 0;
+    unsigned check = 0;          // FNV-1a of the bytes above
+};
+
+class ScoreStore {
+public:
+    explicit ScoreStore(const std::string& directory);
+    ~ScoreStore();
+    ScoreStore(const ScoreStore&) = delete;
+    ScoreStore& operator=(const ScoreStore&) = delete;
+
+    //Loads the index and journal, repairs a torn journal tail and starts the writer
+    bool open();
+
+    //Queues a score for the writer thread; never touches the disk itself
+    void submit(Level level, int score, unsigned long long seed, unsigned long long ticks);
+    //Blocks until every submitted score is on disk
+    void flush();
+    //Folds the journal into the index on the writer thread
+    void requestCompaction();
+
+    int best(Level level) const;
+    //Best scores of a level, highest first
+    void top(Level level, size_t count, std::vector<ScoreEntry>& out) const;
+    size_t totalEntries() const;
+
+private:
+    struct JournalHeader {
+        char magic[4];
+        unsigned version;
+        unsigned long long generation;
+    };
+
+    struct IndexHeader {
+        char magic[4];
+        unsigned version;
+        unsigned long long generation;   // journal generation already folded in
+        unsigned long long counts[3];    // records per level, in level order
+    };
+
+    //Maps indexPath into file and checks it; false (and file closed) if damaged
+    bool openIndex(MappedFile& file, unsigned long long& generation) const;
+    bool loadIndex();
+    bool loadJournal();
+    bool startJournal(unsigned long long newGeneration);
+    void writerLoop();
+    bool append(const std::vector<ScoreEntry>& batch);
+    bool compact();
+    const ScoreEntry* indexSection(int level, size_t& count) const;
+
+    std::string journalPath, indexPath;
+
+    //Read side, guarded by stateLock
+    mutable std::mutex stateLock;
+    MappedFile index;
+    unsigned long long indexGeneration = 0;
+    std::vector<ScoreEntry> journalEntries[3];
+    size_t journalCount = 0;
+
+    //Writer side
+    FILE* journal = nullptr;
+    unsigned long long journalGeneration = 1;
+
+    std::mutex queueLock;
+    std::condition_variable queueReady;
+    std::condition_variable queueDrained;
+    std::vector<ScoreEntry> pending;
+    unsigned long long submitted = 0;
+    unsigned long long written = 0;
+    bool compactRequested = false;
+    bool stopping = false;
+    std::thread writer;
+};
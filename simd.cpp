@@ -0,0 +1,241 @@
+#include "simd.h"
+
+//SSE2 is always there on x86-64, so only 64-bit x86 gets the vector paths
+#if defined(__x86_64__) || defined(_M_X64)
+#define SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+//GCC and Clang only emit AVX2 inside functions marked for it, so the rest of
+//the program still runs on CPUs without it. MSVC needs no marking.
+#if defined(SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_AVX2 __attribute__((target("avx2")))
+#else
+#define SIMD_AVX2
+#endif
+
+// Scalar
+
+static void integrateScalar(float* x, float* y, const float* vx, const float* vy, size_t n, float dt) {
+    for (size_t i = 0; i < n; i++) {
+        x[i] += vx[i] * dt;
+        y[i] += vy[i] * dt;
+    }
+}
+
+static size_t cullScalar(const float* x, const float* y, const float* w, unsigned char* alive, size_t n, const CullBounds& bounds) {
+    size_t culled = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (alive[i] && (y[i] < bounds.minY || y[i] > bounds.maxY || x[i] + w[i] < bounds.minRight)) {
+            alive[i] = 0;
+            culled++;
+        }
+    }
+    return culled;
+}
+
+static size_t overlapScalar(const Aabb& box, const float* x, const float* y, const float* w, const float* h, size_t n, unsigned char* bits) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (i % 8 == 0) bits[i / 8] = 0;
+        if (box.x < x[i] + w[i] && x[i] < box.x + box.w && box.y < y[i] + h[i] && y[i] < box.y + box.h) {
+            bits[i / 8] |= static_cast<unsigned char>(1 << (i % 8));
+            count++;
+        }
+    }
+    return count;
+}
+
+#ifdef SIMD_X86
+
+static size_t countBits(int mask) {
+    size_t count = 0;
+    for (; mask; mask &= mask - 1) {
+        count++;
+    }
+    return count;
+}
+
+// SSE2, 4 lanes. Tails fall back to the scalar loop.
+
+static void integrateSse(float* x, float* y, const float* vx, const float* vy, size_t n, float dt) {
+    __m128 step = _mm_set1_ps(dt);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(_mm_loadu_ps(vx + i), step)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(_mm_loadu_ps(vy + i), step)));
+    }
+    integrateScalar(x + i, y + i, vx + i, vy + i, n - i, dt);
+}
+
+static size_t cullSse(const float* x, const float* y, const float* w, unsigned char* alive, size_t n, const CullBounds& bounds) {
+    __m128 minY = _mm_set1_ps(bounds.minY);
+    __m128 maxY = _mm_set1_ps(bounds.maxY);
+    __m128 minRight = _mm_set1_ps(bounds.minRight);
+    size_t culled = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 right = _mm_add_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(w + i));
+        __m128 out = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(py, minY), _mm_cmpgt_ps(py, maxY)), _mm_cmplt_ps(right, minRight));
+        int mask = _mm_movemask_ps(out);
+        //Most entities stay on screen, so whole blocks are usually skipped here
+        if (mask == 0) continue;
+        for (int lane = 0; lane < 4; lane++) {
+            if ((mask >> lane) & 1 && alive[i + lane]) {
+                alive[i + lane] = 0;
+                culled++;
+            }
+        }
+    }
+    return culled + cullScalar(x + i, y + i, w + i, alive + i, n - i, bounds);
+}
+
+static size_t overlapSse(const Aabb& box, const float* x, const float* y, const float* w, const float* h, size_t n, unsigned char* bits) {
+    __m128 boxX = _mm_set1_ps(box.x);
+    __m128 boxY = _mm_set1_ps(box.y);
+    __m128 boxRight = _mm_set1_ps(box.x + box.w);
+    __m128 boxBottom = _mm_set1_ps(box.y + box.h);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int mask = 0;
+        for (int half = 0; half < 8; half += 4) {
+            __m128 px = _mm_loadu_ps(x + i + half);
+            __m128 py = _mm_loadu_ps(y + i + half);
+            __m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmplt_ps(boxX, _mm_add_ps(px, _mm_loadu_ps(w + i + half))), _mm_cmplt_ps(px, boxRight)),
+                                    _mm_and_ps(_mm_cmplt_ps(boxY, _mm_add_ps(py, _mm_loadu_ps(h + i + half))), _mm_cmplt_ps(py, boxBottom)));
+            mask |= _mm_movemask_ps(hit) << half;
+        }
+        bits[i / 8] = static_cast<unsigned char>(mask);
+        count += countBits(mask);
+    }
+    return count + overlapScalar(box, x + i, y + i, w + i, h + i, n - i, bits + i / 8);
+}
+
+// AVX2, 8 lanes. Short runs stay on SSE: the first 256-bit instructions
+// after a pause run slowly while the upper lanes power up, which costs more
+// than a few dozen entities can win back.
+
+static const size_t AVX_MIN_COUNT = 256;
+
+SIMD_AVX2 static void integrateAvxWide(float* x, float* y, const float* vx, const float* vy, size_t n, float dt) {
+    __m256 step = _mm256_set1_ps(dt);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(_mm256_loadu_ps(vx + i), step)));
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(_mm256_loadu_ps(vy + i), step)));
+    }
+    integrateScalar(x + i, y + i, vx + i, vy + i, n - i, dt);
+}
+
+SIMD_AVX2 static size_t cullAvxWide(const float* x, const float* y, const float* w, unsigned char* alive, size_t n, const CullBounds& bounds) {
+    __m256 minY = _mm256_set1_ps(bounds.minY);
+    __m256 maxY = _mm256_set1_ps(bounds.maxY);
+    __m256 minRight = _mm256_set1_ps(bounds.minRight);
+    size_t culled = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 py = _mm256_loadu_ps(y + i);
+        __m256 right = _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(w + i));
+        __m256 out = _mm256_or_ps(_mm256_or_ps(_mm256_cmp_ps(py, minY, _CMP_LT_OQ), _mm256_cmp_ps(py, maxY, _CMP_GT_OQ)),
+                                  _mm256_cmp_ps(right, minRight, _CMP_LT_OQ));
+        int mask = _mm256_movemask_ps(out);
+        if (mask == 0) continue;
+        for (int lane = 0; lane < 8; lane++) {
+            if ((mask >> lane) & 1 && alive[i + lane]) {
+                alive[i + lane] = 0;
+                culled++;
+            }
+        }
+    }
+    return culled + cullScalar(x + i, y + i, w + i, alive + i, n - i, bounds);
+}
+
+SIMD_AVX2 static size_t overlapAvxWide(const Aabb& box, const float* x, const float* y, const float* w, const float* h, size_t n, unsigned char* bits) {
+    __m256 boxX = _mm256_set1_ps(box.x);
+    __m256 boxY = _mm256_set1_ps(box.y);
+    __m256 boxRight = _mm256_set1_ps(box.x + box.w);
+    __m256 boxBottom = _mm256_set1_ps(box.y + box.h);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 px = _mm256_loadu_ps(x + i);
+        __m256 py = _mm256_loadu_ps(y + i);
+        __m256 hitX = _mm256_and_ps(_mm256_cmp_ps(boxX, _mm256_add_ps(px, _mm256_loadu_ps(w + i)), _CMP_LT_OQ), _mm256_cmp_ps(px, boxRight, _CMP_LT_OQ));
+        __m256 hitY = _mm256_and_ps(_mm256_cmp_ps(boxY, _mm256_add_ps(py, _mm256_loadu_ps(h + i)), _CMP_LT_OQ), _mm256_cmp_ps(py, boxBottom, _CMP_LT_OQ));
+        int mask = _mm256_movemask_ps(_mm256_and_ps(hitX, hitY));
+        bits[i / 8] = static_cast<unsigned char>(mask);
+        count += countBits(mask);
+    }
+    return count + overlapScalar(box, x + i, y + i, w + i, h + i, n - i, bits + i / 8);
+}
+
+//The size check lives outside the AVX2 functions: the compiler may touch the
+//wide registers in their prologue, and going from there straight into SSE
+//code without clearing them costs a state transition.
+static void integrateAvx(float* x, float* y, const float* vx, const float* vy, size_t n, float dt) {
+    if (n < AVX_MIN_COUNT) integrateSse(x, y, vx, vy, n, dt);
+    else integrateAvxWide(x, y, vx, vy, n, dt);
+}
+
+static size_t cullAvx(const float* x, const float* y, const float* w, unsigned char* alive, size_t n, const CullBounds& bounds) {
+    return n < AVX_MIN_COUNT ? cullSse(x, y, w, alive, n, bounds) : cullAvxWide(x, y, w, alive, n, bounds);
+}
+
+static size_t overlapAvx(const Aabb& box, const float* x, const float* y, const float* w, const float* h, size_t n, unsigned char* bits) {
+    return n < AVX_MIN_COUNT ? overlapSse(box, x, y, w, h, n, bits) : overlapAvxWide(box, x, y, w, h, n, bits);
+}
+
+static bool cpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    //The OS also has to save the YMM registers on context switches
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    return avx2 && osxsave && (_xgetbv(0) & 6) == 6;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+static const SimdKernels SCALAR_KERNELS = { "scalar", integrateScalar, cullScalar, overlapScalar };
+#ifdef SIMD_X86
+static const SimdKernels SSE_KERNELS = { "sse2", integrateSse, cullSse, overlapSse };
+static const SimdKernels AVX_KERNELS = { "avx2", integrateAvx, cullAvx, overlapAvx };
+#endif
+
+const SimdKernels& scalarKernels() {
+    return SCALAR_KERNELS;
+}
+
+const SimdKernels* sseKernels() {
+#ifdef SIMD_X86
+    return &SSE_KERNELS;
+#else
+    return nullptr;
+#endif
+}
+
+const SimdKernels* avxKernels() {
+#ifdef SIMD_X86
+    static bool supported = cpuHasAvx2();
+    return supported ? &AVX_KERNELS : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const SimdKernels& simdKernels() {
+    static const SimdKernels* best = avxKernels() ? avxKernels() : sseKernels() ? sseKernels() : &scalarKernels();
+    return *best;
+}
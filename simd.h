@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+// Data-parallel kernels for the SoA entity arrays, in scalar, SSE2 and AVX2
+// versions. simdKernels() picks the widest one the CPU supports the first
+// time it is called.
+//
+// Every version does the same float operations in the same order (a
+// multiply and then an add, never fused), so they produce bit-identical
+// results and replays do not depend on which one ran.
+
+struct Aabb {
+    float x, y, w, h;
+};
+
+//An entity is culled when y < minY, y > maxY or x + w < minRight
+struct CullBounds {
+    float minY, maxY, minRight;
+};
+
+struct SimdKernels {
+    const char* name;
+    //x += vx * dt, y += vy * dt
+    void (*integrate)(float* x, float* y, const float* vx, const float* vy, size_t n, float dt);
+    //Clears alive for entities outside the bounds; returns how many were newly culled
+    size_t (*cull)(const float* x, const float* y, const float* w, unsigned char* alive, size_t n, const CullBounds& bounds);
+    //One bit per entity in bits (LSB first, 8 per byte) set if it overlaps box; returns the count
+    size_t (*overlap)(const Aabb& box, const float* x, const float* y, const float* w, const float* h, size_t n, unsigned char* bits);
+};
+
+const SimdKernels& simdKernels();
+const SimdKernels& scalarKernels();
+//nullptr when the CPU or the build does not support them
+const SimdKernels* sseKernels();
+const SimdKernels* avxKernels();
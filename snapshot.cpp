@@ -0,0 +1,160 @@
+#include "snapshot.h"
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+//After a stall longer than this the simulation skips ahead instead of catching up
+static const chrono::milliseconds MAX_CATCH_UP(250);
+
+void EntitySnapshot::capture(const EntityStore& store) {
+    x.clear();
+    y.clear();
+    vx.clear();
+    vy.clear();
+    w.clear();
+    h.clear();
+    for (size_t i = 0; i < store.size(); i++) {
+        if (store.alive[i]) {
+            x.push_back(store.x[i]);
+            y.push_back(store.y[i]);
+            vx.push_back(store.vx[i]);
+            vy.push_back(store.vy[i]);
+            w.push_back(store.w[i]);
+            h.push_back(store.h[i]);
+        }
+    }
+}
+
+float GameSnapshot::alpha(chrono::steady_clock::time_point now) const {
+    float elapsed = chrono::duration<float>(now - time).count();
+    return min(max(elapsed / TICK_DT, 0.0f), 1.0f);
+}
+
+SimThread::SimThread(Game& game, Profiler* profiler) : game(game), profiler(profiler) {
+}
+
+SimThread::~SimThread() {
+    stop();
+}
+
+void SimThread::start(const Replay* newReplay, Replay* newRecording) {
+    stop();
+    replay = newReplay;
+    recording = newRecording;
+    replayTick = 0;
+    shotsFired = 0;
+    heartsCollected = 0;
+    tickInput.reset();
+    queue.clear();
+    GameEffect stale;
+    while (effectQueue.pop(stale)) {
+    }
+    fill(begin(presses), end(presses), 0u);
+    //Rewinding can go back as far as the state the game starts from
+    rewindBuffer.clear();
+    rewindBuffer.capture(game);
+    rewindRequest = 0;
+    stopping = false;
+    done = false;
+    game.profiler = profiler;
+
+    //The renderer has something to draw before the first tick
+    publish(game.playerX, game.playerY);
+    buffer.update();
+    thread = std::thread(&SimThread::run, this);
+}
+
+void SimThread::stop() {
+    stopping = true;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void SimThread::publish(float prevPlayerX, float prevPlayerY) {
+    GameSnapshot& snapshot = buffer.writeBuffer();
+    snapshot.tick = game.tick;
+    snapshot.time = chrono::steady_clock::now();
+    snapshot.playerX = game.playerX;
+    snapshot.playerY = game.playerY;
+    snapshot.prevPlayerX = prevPlayerX;
+    snapshot.prevPlayerY = prevPlayerY;
+    snapshot.score = game.score;
+    snapshot.hearts = game.hearts;
+    snapshot.over = game.over;
+    snapshot.shotsFired = shotsFired;
+    snapshot.heartsCollected = heartsCollected;
+    copy(begin(presses), end(presses), snapshot.presses);
+    copy(begin(pressTime), end(pressTime), snapshot.pressTime);
+    snapshot.bullets.capture(game.bullets);
+    snapshot.aliens.capture(game.aliens);
+    snapshot.bonusHearts.capture(game.bonusHearts);
+    snapshot.jobTimings.clear();
+    if (game.jobs) {
+        snapshot.jobTimings = game.jobs->tickTimings();
+    }
+    buffer.publish();
+}
+
+void SimThread::run() {
+    const auto tickLength = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(TICK_DT));
+    auto nextTick = chrono::steady_clock::now();
+    while (!stopping.load(memory_order_relaxed)) {
+        nextTick += tickLength;
+        auto now = chrono::steady_clock::now();
+        if (now - nextTick > MAX_CATCH_UP) {
+            nextTick = now;
+        }
+        else if (nextTick > now) {
+            this_thread::sleep_until(nextTick);
+        }
+
+        InputEvent event;
+        while (queue.popUntil(nextTick, event)) {
+            tickInput.apply(event);
+            if (event.pressed && !event.repeat && actionInputBit(event.action)) {
+                presses[event.action]++;
+                pressTime[event.action] = event.time;
+            }
+        }
+        unsigned rewindTicks = rewindRequest.exchange(0, memory_order_relaxed);
+        if (rewindTicks && !replay && rewindBuffer.rewind(game, rewindTicks) && recording) {
+            //One input per tick from tick 0, so the recording stays a valid replay
+            recording->inputs.resize(min(recording->inputs.size(), static_cast<size_t>(game.tick)));
+        }
+
+        GameInput input = tickInput.take();
+        if (replay) {
+            if (replayTick >= replay->inputs.size()) {
+                break;
+            }
+            input = unpackInput(replay->inputs[replayTick++]);
+        }
+        if (recording) {
+            recording->record(input);
+        }
+
+        float prevPlayerX = game.playerX;
+        float prevPlayerY = game.playerY;
+        if (profiler) profiler->beginFrame();
+        GameEvents events = step(game, TICK_DT, input);
+        if (profiler) profiler->endFrame();
+        rewindBuffer.capture(game);
+        if (autosave && !replay && !game.over && game.tick % AUTOSAVE_TICKS == 0) {
+            autosave->submit(rewindBuffer.newest());
+        }
+        //Effects are only for show; a full queue just loses a burst
+        for (const GameEffect& effect : game.effects) {
+            effectQueue.push(effect);
+        }
+        shotsFired += events.shotsFired;
+        heartsCollected += events.heartsCollected;
+        publish(prevPlayerX, prevPlayerY);
+
+        if (game.over) {
+            break;
+        }
+    }
+    done.store(true, memory_order_release);
+}
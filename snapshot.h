@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "game.h"
+#include "input.h"
+#include "replay.h"
+#include "savestate.h"
+
+// Hand-off between the simulation thread and the render thread.
+//
+// The simulation ticks at TICK_RATE on its own thread and after every tick
+// copies what the renderer needs into a GameSnapshot. Snapshots go through
+// a triple buffer: the writer always has a slot of its own, the reader
+// always has a slot of its own, and the third slot is swapped with one
+// atomic exchange. Neither side waits for the other, and the reader just
+// keeps the newest snapshot if it falls behind.
+
+template <class T>
+class TripleBuffer {
+public:
+    //Slot the writer may fill; it stays private until publish()
+    T& writeBuffer() { return slots[back]; }
+    void publish() {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    //Swaps in the newest published value, if there is one; true if it changed
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+    const T& readBuffer() const { return slots[front]; }
+
+private:
+    static const unsigned INDEX = 3;
+    static const unsigned FRESH = 4;
+
+    T slots[3];
+    unsigned back = 0;
+    unsigned front = 1;
+    std::atomic<unsigned> middle{ 2 };
+};
+
+// Bounded single-producer, single-consumer queue for things that must not
+// be lost when the reader skips a snapshot. A full queue refuses the push.
+
+template <class T, size_t SIZE>
+class SpscQueue {
+public:
+    bool push(const T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) >= SIZE) {
+            return false;
+        }
+        slots[t % SIZE] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    bool pop(T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = slots[h % SIZE];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T slots[SIZE];
+    std::atomic<size_t> head{ 0 };
+    std::atomic<size_t> tail{ 0 };
+};
+
+//Live entities of one kind, with velocities so the renderer can interpolate
+struct EntitySnapshot {
+    std::vector<float> x, y, vx, vy, w, h;
+
+    size_t size() const { return x.size(); }
+    //Copies the live entities; the vectors keep their capacity between ticks
+    void capture(const EntityStore& store);
+};
+
+struct GameSnapshot {
+    unsigned long long tick = 0;
+    std::chrono::steady_clock::time_point time;
+    float playerX = 0, playerY = 0;
+    float prevPlayerX = 0, prevPlayerY = 0;
+    int score = 0;
+    int hearts = 0;
+    bool over = false;
+
+    //Running totals for the current game, so a reader that skips snapshots
+    //still notices every shot and pickup
+    unsigned shotsFired = 0;
+    unsigned heartsCollected = 0;
+    //Newest press of each game action applied so far, with a running count,
+    //so the renderer can time it to the first frame that shows it
+    unsigned presses[ACTION_COUNT] = {};
+    std::chrono::steady_clock::time_point pressTime[ACTION_COUNT];
+
+    EntitySnapshot bullets, aliens, bonusHearts;
+    std::vector<JobTiming> jobTimings;
+
+    //0 right at the tick, 1 a whole tick later
+    float alpha(std::chrono::steady_clock::time_point now) const;
+};
+
+//One rewind request goes back this far
+const unsigned REWIND_STEP_TICKS = TICK_RATE;
+//How often the autosave file is rewritten during play
+const unsigned long long AUTOSAVE_TICKS = 5 * TICK_RATE;
+
+// Runs step() on a thread of its own at a fixed rate. The render thread
+// pushes key events with pushInput() and reads snapshots(). Each tick
+// applies the events stamped up to the time it was due, in order. The Game
+// must not be touched from outside until finished() is true or stop() has
+// returned.
+//
+// Every tick's state also goes into a rewind ring, and every AUTOSAVE_TICKS
+// the newest one is handed to the autosave writer, if there is one, which
+// puts it on disk from its own thread. A crash loses a few seconds at most.
+// Replays never rewind or autosave.
+
+class SimThread {
+public:
+    SimThread(Game& game, Profiler* profiler);
+    ~SimThread();
+    SimThread(const SimThread&) = delete;
+    SimThread& operator=(const SimThread&) = delete;
+
+    //Replays play back their inputs; recording, if set, gets every tick's input
+    void start(const Replay* replay, Replay* recording);
+    void stop();
+
+    //Only the render thread may push; false if the queue was full
+    bool pushInput(const InputEvent& event) { return queue.push(event); }
+    //Goes back this many ticks before the next one; requests add up
+    void requestRewind(unsigned ticks) { rewindRequest.fetch_add(ticks, std::memory_order_relaxed); }
+    //Null turns autosaving off; set it before start()
+    void setAutosave(StateWriter* writer) { autosave = writer; }
+    //True once the game is over or the replay has run out
+    bool finished() const { return done.load(std::memory_order_acquire); }
+    //Read side of the snapshots; only the render thread may use it
+    TripleBuffer<GameSnapshot>& snapshots() { return buffer; }
+    //Effects of every tick, in order; only the render thread may pop
+    SpscQueue<GameEffect, 1024>& effects() { return effectQueue; }
+
+private:
+    void run();
+    void publish(float prevPlayerX, float prevPlayerY);
+
+    Game& game;
+    Profiler* profiler;
+    const Replay* replay = nullptr;
+    Replay* recording = nullptr;
+    size_t replayTick = 0;
+    unsigned shotsFired = 0;
+    unsigned heartsCollected = 0;
+    TickInput tickInput;
+    unsigned presses[ACTION_COUNT] = {};
+    std::chrono::steady_clock::time_point pressTime[ACTION_COUNT];
+    RewindBuffer rewindBuffer;
+    StateWriter* autosave = nullptr;
+
+    std::thread thread;
+    InputQueue queue;
+    SpscQueue<GameEffect, 1024> effectQueue;
+    std::atomic<unsigned> rewindRequest{ 0 };
+    std::atomic<bool> stopping{ false };
+    std::atomic<bool> done{ false };
+    TripleBuffer<GameSnapshot> buffer;
+};
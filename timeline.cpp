@@ -0,0 +1,250 @@
+#include "timeline.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "game.h"
+
+using namespace std;
+
+//Guards against a typo like "repeat 100000000" eating all memory
+static const size_t MAX_TIMELINE_EVENTS = 1 << 22;
+
+SpawnTimeline clockTimeline(unsigned alienTicks, unsigned heartTicks) {
+    //One cycle covers both intervals, so looping it repeats the fixed clocks exactly
+    SpawnTimeline result;
+    alienTicks = max(alienTicks, 1u);
+    heartTicks = max(heartTicks, 1u);
+    unsigned long long loop = alienTicks;
+    while (loop % heartTicks != 0) {
+        loop += alienTicks;
+    }
+    result.loopTicks = static_cast<unsigned>(loop);
+    SpawnEvent alien;
+    alien.kind = SPAWN_ALIEN;
+    for (unsigned tick = alienTicks; tick <= result.loopTicks; tick += alienTicks) {
+        alien.tick = tick;
+        result.events.push_back(alien);
+    }
+    SpawnEvent heart;
+    heart.kind = SPAWN_HEART;
+    for (unsigned tick = heartTicks; tick <= result.loopTicks; tick += heartTicks) {
+        heart.tick = tick;
+        result.events.push_back(heart);
+    }
+    //Aliens before hearts on shared ticks
+    stable_sort(result.events.begin(), result.events.end(), [](const SpawnEvent& a, const SpawnEvent& b) { return a.tick < b.tick; });
+    return result;
+}
+
+const SpawnTimeline& defaultTimeline() {
+    static const SpawnTimeline timeline = clockTimeline(ALIEN_SPAWN_TICKS, HEART_SPAWN_TICKS);
+    return timeline;
+}
+
+unsigned long long timelineHash(const SpawnTimeline& timeline) {
+    unsigned long long hash = FNV_OFFSET_BASIS;
+    hashBytes(hash, &timeline.loopTicks, sizeof(timeline.loopTicks));
+    //Field by field, so struct padding never reaches the hash
+    for (const SpawnEvent& event : timeline.events) {
+        hashBytes(hash, &event.tick, sizeof(event.tick));
+        hashBytes(hash, &event.kind, sizeof(event.kind));
+        hashBytes(hash, &event.pattern, sizeof(event.pattern));
+        hashBytes(hash, &event.count, sizeof(event.count));
+        hashBytes(hash, &event.x, sizeof(event.x));
+        hashBytes(hash, &event.spacing, sizeof(event.spacing));
+        hashBytes(hash, &event.speed, sizeof(event.speed));
+    }
+    return hash;
+}
+
+//"2s" and "2" are seconds, "120t" is ticks
+static bool parseTime(const string& text, unsigned& ticks) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    double value = strtod(text.c_str(), &end);
+    string unit(end);
+    if (end == text.c_str() || value < 0 || (unit != "" && unit != "s" && unit != "t")) {
+        return false;
+    }
+    double result = unit == "t" ? value : value * TICK_RATE;
+    if (result > 4e9) {
+        return false;
+    }
+    ticks = static_cast<unsigned>(llround(result));
+    return true;
+}
+
+static bool parseNumber(const string& text, double& value) {
+    char* end = nullptr;
+    value = strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0';
+}
+
+static bool parsePattern(const string& text, SpawnPattern& pattern) {
+    if (text == "random") pattern = PATTERN_RANDOM;
+    else if (text == "row") pattern = PATTERN_ROW;
+    else if (text == "column") pattern = PATTERN_COLUMN;
+    else if (text == "vee") pattern = PATTERN_VEE;
+    else return false;
+    return true;
+}
+
+//Reads one "at ..." line into an event plus its repeat settings
+static bool parseEvent(istringstream& words, SpawnEvent& event, unsigned& repeat, unsigned& every, string& error) {
+    string word;
+    if (!(words >> word) || !parseTime(word, event.tick)) {
+        error = "expected a time after 'at'";
+        return false;
+    }
+    if (!(words >> word) || (word != "alien" && word != "heart")) {
+        error = "expected 'alien' or 'heart'";
+        return false;
+    }
+    event.kind = word == "heart" ? SPAWN_HEART : SPAWN_ALIEN;
+
+    string option, value;
+    while (words >> option) {
+        if (!(words >> value)) {
+            error = "missing value for '" + option + "'";
+            return false;
+        }
+        double number = 0;
+        if (option == "count" && parseNumber(value, number) && number >= 1 && number <= 65535) {
+            event.count = static_cast<unsigned short>(number);
+        }
+        else if (option == "x" && value == "random") {
+            event.x = -1.0f;
+        }
+        else if (option == "x" && parseNumber(value, number) && number >= 0) {
+            event.x = static_cast<float>(number);
+        }
+        else if (option == "pattern" && parsePattern(value, event.pattern)) {
+        }
+        else if (option == "spacing" && parseNumber(value, number) && number >= 0) {
+            event.spacing = static_cast<float>(number);
+        }
+        else if (option == "speed" && parseNumber(value, number) && number > 0) {
+            event.speed = static_cast<float>(number);
+        }
+        else if (option == "repeat" && parseNumber(value, number) && number >= 1 && number <= MAX_TIMELINE_EVENTS) {
+            repeat = static_cast<unsigned>(number);
+        }
+        else if (option == "every" && parseTime(value, every) && every > 0) {
+        }
+        else {
+            error = "bad option '" + option + " " + value + "'";
+            return false;
+        }
+    }
+    if (repeat > 1 && every == 0) {
+        error = "'repeat' needs 'every'";
+        return false;
+    }
+    return true;
+}
+
+bool checkTimeline(const SpawnTimeline& timeline, string& error) {
+    if (timeline.events.size() > MAX_TIMELINE_EVENTS) {
+        error = "more than " + to_string(MAX_TIMELINE_EVENTS) + " events";
+        return false;
+    }
+    unsigned lastTick = 0;
+    for (size_t i = 0; i < timeline.events.size(); i++) {
+        const SpawnEvent& event = timeline.events[i];
+        //count 0 would make spawnGroup's spacing * (count - 1) wrap
+        bool sensible = (event.kind == SPAWN_ALIEN || event.kind == SPAWN_HEART) && event.pattern <= PATTERN_VEE &&
+                        event.count >= 1 && isfinite(event.x) && isfinite(event.spacing) && event.spacing >= 0 &&
+                        isfinite(event.speed) && event.speed > 0;
+        if (!sensible) {
+            error = "event " + to_string(i) + " is damaged";
+            return false;
+        }
+        if (event.tick < lastTick) {
+            error = "event " + to_string(i) + " is out of order";
+            return false;
+        }
+        lastTick = event.tick;
+    }
+    if (timeline.loopTicks > 0 && lastTick > timeline.loopTicks) {
+        error = "loop is shorter than the last event";
+        return false;
+    }
+    return true;
+}
+
+bool parseTimeline(istream& in, SpawnTimeline& timeline, string& error) {
+    timeline.events.clear();
+    timeline.loopTicks = 0;
+    string line;
+    int lineNumber = 0;
+    while (getline(in, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+        istringstream words(line);
+        string command;
+        if (!(words >> command)) {
+            continue;
+        }
+
+        string message;
+        if (command == "loop") {
+            string value;
+            if (!(words >> value) || !parseTime(value, timeline.loopTicks) || timeline.loopTicks == 0) {
+                message = "expected a length after 'loop'";
+            }
+        }
+        else if (command == "at") {
+            SpawnEvent event;
+            unsigned repeat = 1, every = 0;
+            if (parseEvent(words, event, repeat, every, message)) {
+                if (timeline.events.size() + repeat > MAX_TIMELINE_EVENTS) {
+                    message = "more than " + to_string(MAX_TIMELINE_EVENTS) + " events";
+                }
+                else if (event.tick + static_cast<unsigned long long>(repeat - 1) * every > 0xFFFFFFFFull) {
+                    message = "repeat runs past the end of time";
+                }
+                for (unsigned i = 0; i < repeat && message.empty(); i++) {
+                    timeline.events.push_back(event);
+                    event.tick += every;
+                }
+            }
+        }
+        else {
+            message = "unknown command '" + command + "'";
+        }
+        if (!message.empty()) {
+            error = "line " + to_string(lineNumber) + ": " + message;
+            timeline.events.clear();
+            timeline.loopTicks = 0;
+            return false;
+        }
+    }
+
+    //Stable, so events on the same tick spawn in script order
+    stable_sort(timeline.events.begin(), timeline.events.end(), [](const SpawnEvent& a, const SpawnEvent& b) { return a.tick < b.tick; });
+    if (!checkTimeline(timeline, error)) {
+        timeline.events.clear();
+        timeline.loopTicks = 0;
+        return false;
+    }
+    return true;
+}
+
+bool loadTimeline(const string& path, SpawnTimeline& timeline) {
+    ifstream in(path);
+    if (!in.is_open()) {
+        cerr << "Error: Could not load wave script " << path << endl;
+        return false;
+    }
+    string error;
+    if (!parseTimeline(in, timeline, error)) {
+        cerr << "Error: " << path << " " << error << endl;
+        return false;
+    }
+    return true;
+}
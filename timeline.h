@@ -0,0 +1,74 @@
+#pragma once
+
+#include <istream>
+#include <string>
+#include <vector>
+
+// Scripted spawning. A wave script is compiled once, at load, into a list of
+// spawn events sorted by tick; the game keeps a cursor into it and each tick
+// only looks at the events that are due, so a level can hold tens of
+// thousands of scripted spawns at no per-tick cost.
+//
+// Script format, one event per line, '#' starts a comment:
+//
+//   loop 14s
+//   at 2s alien
+//   at 5.5s alien count 12 pattern row x 100 spacing 140
+//   at 600t heart x random
+//   at 10s alien count 5 pattern vee x 900 speed 1.5 repeat 20 every 0.5s
+//
+// Times are seconds ("2s", or a bare number) or simulation ticks ("600t").
+// "loop" restarts the script after that long; without it spawning stops once
+// the last event has fired. Options after the entity type:
+//   count N          entities in the group (default 1)
+//   x X | x random   left edge of the group (default random)
+//   pattern P        random, row, column or vee (default random)
+//   spacing S        pixels between group members (default: entity size)
+//   speed M          multiplier of the level's alien speed (default 1)
+//   repeat N every T the same event N times, T apart
+
+enum SpawnKind : unsigned char { SPAWN_ALIEN, SPAWN_HEART };
+
+enum SpawnPattern : unsigned char {
+    PATTERN_RANDOM,   // every member at its own random x
+    PATTERN_ROW,      // side by side along the top edge
+    PATTERN_COLUMN,   // one behind the other
+    PATTERN_VEE       // leader in front, the rest trailing to both sides
+};
+
+//x below zero means "pick at random"; spacing zero means "entity size"
+struct SpawnEvent {
+    unsigned tick = 0;    // ticks after the start of the script (or loop)
+    SpawnKind kind = SPAWN_ALIEN;
+    SpawnPattern pattern = PATTERN_RANDOM;
+    unsigned short count = 1;
+    float x = -1.0f;
+    float spacing = 0.0f;
+    float speed = 1.0f;
+};
+
+struct SpawnTimeline {
+    std::vector<SpawnEvent> events;   // sorted by tick, script order within a tick
+    unsigned loopTicks = 0;           // 0 = play once
+
+    size_t size() const { return events.size(); }
+};
+
+//One alien every alienTicks and one heart every heartTicks, forever
+SpawnTimeline clockTimeline(unsigned alienTicks, unsigned heartTicks);
+//clockTimeline(ALIEN_SPAWN_TICKS, HEART_SPAWN_TICKS)
+const SpawnTimeline& defaultTimeline();
+
+//FNV-1a over the loop length and every event, so two timelines that spawn
+//the same way share an id
+unsigned long long timelineHash(const SpawnTimeline& timeline);
+
+//True if every event is one the script compiler could have produced (known
+//kind and pattern, count >= 1, finite x, spacing >= 0, speed > 0), ticks never
+//go backwards and the loop, if any, covers the last event. For timelines read
+//back from files, which step() would otherwise trust
+bool checkTimeline(const SpawnTimeline& timeline, std::string& error);
+
+//Compiles a script; errors name the line and leave the timeline empty
+bool parseTimeline(std::istream& in, SpawnTimeline& timeline, std::string& error);
+bool loadTimeline(const std::string& path, SpawnTimeline& timeline);